@@ -0,0 +1,104 @@
+// Measures how much a single tick synchronization costs depending on the
+// amount of threads. Every thread does no work between the barriers, so the
+// result is the pure overhead of the barrier itself.
+//
+// usage: barrierBench [rounds] [max_threads]
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "engine/core/TickBarrier.h"
+
+namespace {
+// Barrier which replicates the previous Core::ThreadReady implementation:
+// the mutex, the condition variable and the polling operational thread.
+class CondvarBarrier {
+ public:
+  explicit CondvarBarrier(size_t count) : count_(count) {}
+
+  void ArriveAndWait(bool operational) {
+    std::unique_lock lock(mutex_);
+    if (!operational) {
+      const uint64_t generation = generation_;
+      waiting_ += 1;
+      var_.wait(lock, [&]() { return generation != generation_; });
+      return;
+    }
+    lock.unlock();
+    while (true) {
+      lock.lock();
+      if (waiting_ + 1 >= count_) {
+        break;
+      }
+      lock.unlock();
+      std::this_thread::sleep_for(std::chrono::microseconds(1));
+    }
+    waiting_ = 0;
+    generation_ += 1;
+    var_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable var_;
+  size_t waiting_ = 0;
+  uint64_t generation_ = 0;
+  const size_t count_;
+};
+
+template <typename Function>
+double MeasureRounds(size_t threads, size_t rounds, Function&& round) {
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < threads; i++) {
+    workers.emplace_back([&round, i, rounds]() {
+      for (size_t r = 0; r < rounds; r++) {
+        round(i);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  auto duration = std::chrono::steady_clock::now() - start;
+  return double(std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+                    .count()) /
+         double(rounds);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t rounds = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+  const size_t hardware =
+      std::max(1U, std::thread::hardware_concurrency());
+  const size_t max_threads =
+      argc > 2 ? std::strtoull(argv[2], nullptr, 10) : hardware;
+
+  std::vector<size_t> counts;
+  for (size_t i = 1; i < max_threads; i *= 2) {
+    counts.push_back(i);
+  }
+  counts.push_back(max_threads);
+
+  std::printf("%8s %10s %18s %18s\n", "threads", "rounds", "tick_barrier_ns",
+              "condvar_ns");
+  for (size_t threads : counts) {
+    engine::core::TickBarrier tick_barrier((uint32_t)threads);
+    double tick_barrier_ns = MeasureRounds(
+        threads, rounds, [&](size_t) { tick_barrier.ArriveAndWait(); });
+
+    CondvarBarrier condvar_barrier(threads);
+    // The condvar barrier is a lot slower, so it gets fewer rounds
+    double condvar_ns =
+        MeasureRounds(threads, std::max<size_t>(rounds / 10, 1), [&](size_t i) {
+          condvar_barrier.ArriveAndWait(i == 0);
+        });
+    std::printf("%8zu %10zu %18.1f %18.1f\n", threads, rounds, tick_barrier_ns,
+                condvar_ns);
+  }
+  return 0;
+}
@@ -0,0 +1,344 @@
+// Runs the Core with synthetic tickers and no window, and reports how well it
+// keeps the tickrate. Tickers spin for their work time in Update, so the
+// results include the scheduling overhead and the load balancing.
+//
+// Workloads:
+//   uniform       every ticker is updated each tick and takes work_ns
+//   heavy_tailed  Pareto distributed work with the mean of work_ns
+//   mixed         tickrates between 1 and 64, like in a big world
+//   pinned        uniform tickers bound to the update threads round robin
+//   low_priority  uniform, 3 of 4 tickers are TickPriority::kLow, so with
+//                 more work than the tick budget it shows the overload policy
+//   batch         uniform work in a single BatchTicker, split into chunks
+//
+// The result is a single JSON document on stdout: the achieved tickrate,
+// jitter of the tick start, per-thread utilisation and time spent in the
+// tick barrier, how many tickers were migrated between threads and how many
+// updates the overload policy has skipped, so it can be compared between
+// releases.
+//
+// The worker pool is configured through the environment, see CoreConfig.
+//
+// usage: coreBench [tickers] [work_ns] [seconds] [unpaced]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engine/Core.h"
+
+namespace {
+using engine::core::BatchTicker;
+using engine::core::Clock;
+using engine::core::Core;
+using engine::core::Ticker;
+using engine::core::TickPriority;
+
+class SpinTicker : public Ticker {
+ public:
+  SpinTicker(uint32_t tickrate, uint64_t work_ns)
+      : Ticker(tickrate), work_ns_(work_ns) {}
+  SpinTicker(uint32_t tickrate, uint64_t work_ns, std::thread::id const& id)
+      : Ticker(tickrate, id), work_ns_(work_ns) {}
+
+  void Update(const uint64_t) override {
+    const uint64_t start = Clock::now_ns();
+    while (Clock::now_ns() - start < work_ns_) {
+    }
+    updates_.store(updates_.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+  }
+  using Ticker::SetPriority;
+  [[nodiscard]] uint64_t updates() const noexcept {
+    return updates_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const uint64_t work_ns_;
+  std::atomic<uint64_t> updates_ = 0;
+};
+
+// Instances count their updates, each one spins for work_ns.
+class SpinBatch : public BatchTicker<uint64_t> {
+ public:
+  SpinBatch(size_t count, uint64_t work_ns)
+      : BatchTicker<uint64_t>(1), work_ns_(work_ns) {
+    items().resize(count);
+  }
+
+  void UpdateChunk(const uint64_t, std::span<uint64_t> chunk) override {
+    const uint64_t start = Clock::now_ns();
+    const uint64_t work = work_ns_ * chunk.size();
+    while (Clock::now_ns() - start < work) {
+    }
+    for (uint64_t& updates : chunk) {
+      updates++;
+    }
+    updates_.fetch_add(chunk.size(), std::memory_order_relaxed);
+  }
+  [[nodiscard]] uint64_t updates() const noexcept {
+    return updates_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const uint64_t work_ns_;
+  std::atomic<uint64_t> updates_ = 0;
+};
+
+// Remembers when every tick has started.
+class TickProbe : public Ticker {
+ public:
+  explicit TickProbe(size_t capacity) : Ticker(1) {
+    SetPhase(engine::core::phase::kPreUpdate);
+    // has to see every tick, even when the Core is overloaded
+    SetPriority(TickPriority::kCritical);
+    tick_times_.reserve(capacity);
+  }
+
+  void Update(const uint64_t) override {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    if (recording_) {
+      tick_times_.push_back(Core::tick_time_ns());
+    }
+  }
+  void Start() {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    tick_times_.clear();
+    recording_ = true;
+  }
+  [[nodiscard]] std::vector<uint64_t> Stop() {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    recording_ = false;
+    return tick_times_;
+  }
+
+ private:
+  std::mutex mutex_;
+  bool recording_ = false;
+  std::vector<uint64_t> tick_times_;
+};
+
+struct Workload {
+  const char* name;
+  uint32_t (*tickrate)(size_t index);
+  bool heavy_tailed;
+  bool pinned;
+  bool low_priority;
+  bool batch;
+};
+
+uint32_t EveryTick(size_t) { return 1; }
+
+uint32_t MixedTickrate(size_t index) {
+  static constexpr uint32_t kTickrates[] = {1, 2, 4, 8, 8, 16, 16,
+                                            16, 32, 32, 32, 64, 64, 64,
+                                            64, 64, 64, 64, 64, 64};
+  return kTickrates[index % std::size(kTickrates)];
+}
+
+// Pareto with alpha 1.5 has a finite mean and an infinite variance, so a few
+// tickers are much slower than the rest.
+uint64_t HeavyTailedWork(std::mt19937_64& random, uint64_t mean_ns) {
+  constexpr double kAlpha = 1.5;
+  const double scale = double(mean_ns) * (kAlpha - 1) / kAlpha;
+  const double u = std::uniform_real_distribution<double>(1e-9, 1)(random);
+  const double work = scale / std::pow(u, 1 / kAlpha);
+  return uint64_t(std::min(work, double(mean_ns) * 1000));
+}
+
+uint64_t Percentile(std::vector<uint64_t> const& sorted, double q) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  const auto rank = std::max<size_t>(size_t(std::ceil(q * sorted.size())), 1);
+  return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+void WriteDistribution(std::ostream& out, std::vector<uint64_t> values) {
+  std::sort(values.begin(), values.end());
+  uint64_t sum = 0;
+  for (uint64_t value : values) {
+    sum += value;
+  }
+  out << "{\"mean_ns\":" << (values.empty() ? 0 : sum / values.size())
+      << ",\"p50_ns\":" << Percentile(values, 0.5)
+      << ",\"p99_ns\":" << Percentile(values, 0.99)
+      << ",\"max_ns\":" << (values.empty() ? 0 : values.back()) << "}";
+}
+
+void RunWorkload(std::ostream& out, Core& core, Workload const& workload,
+                 size_t count, uint64_t work_ns, double seconds) {
+  const auto thread_ids = core.thread_ids();
+  std::mt19937_64 random(42);
+  std::vector<std::shared_ptr<SpinTicker>> tickers;
+  std::vector<std::shared_ptr<Ticker>> batch;
+  std::shared_ptr<SpinBatch> spin_batch;
+  if (workload.batch) {
+    spin_batch = std::make_shared<SpinBatch>(count, work_ns);
+    batch.push_back(spin_batch);
+  }
+  for (size_t i = 0; i < count && !workload.batch; i++) {
+    const uint32_t tickrate = workload.tickrate(i);
+    const uint64_t work =
+        workload.heavy_tailed ? HeavyTailedWork(random, work_ns) : work_ns;
+    tickers.push_back(
+        workload.pinned
+            ? std::make_shared<SpinTicker>(
+                  tickrate, work, thread_ids[i % thread_ids.size()])
+            : std::make_shared<SpinTicker>(tickrate, work));
+    if (workload.low_priority && i % 4 != 0) {
+      tickers.back()->SetPriority(TickPriority::kLow);
+    }
+    batch.push_back(tickers.back());
+  }
+  core.AddTickingObjects(batch);
+  batch.clear();
+
+  auto probe = std::make_shared<TickProbe>(
+      size_t(seconds * core.tickrate() * 2) + 16);
+  core.AddTickingObject(probe);
+
+  // let the schedule settle the offsets and the threads the load
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  uint64_t updates_before = spin_batch ? spin_batch->updates() : 0;
+  for (auto const& ticker : tickers) {
+    updates_before += ticker->updates();
+  }
+  const auto stats_before = core.thread_stats();
+  const auto migrations_before = core.migration_stats();
+  const auto overload_before = core.overload_stats();
+  const uint64_t start = Clock::now_ns();
+  probe->Start();
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  const std::vector<uint64_t> tick_times = probe->Stop();
+  const uint64_t duration = Clock::now_ns() - start;
+  const auto stats_after = core.thread_stats();
+  const auto migrations_after = core.migration_stats();
+  const auto overload_after = core.overload_stats();
+  uint64_t updates = spin_batch ? spin_batch->updates() : 0;
+  for (auto const& ticker : tickers) {
+    updates += ticker->updates();
+  }
+  updates -= updates_before;
+
+  for (auto const& ticker : tickers) {
+    core.RemoveTickingObject(ticker);
+  }
+  if (spin_batch) {
+    core.RemoveTickingObject(spin_batch);
+  }
+  core.RemoveTickingObject(probe);
+
+  std::vector<uint64_t> intervals;
+  std::vector<uint64_t> jitter;
+  const uint64_t period = 1000000000ULL / core.tickrate();
+  for (size_t i = 1; i < tick_times.size(); i++) {
+    const uint64_t interval = tick_times[i] - tick_times[i - 1];
+    intervals.push_back(interval);
+    jitter.push_back(interval > period ? interval - period : period - interval);
+  }
+  const double measured_seconds =
+      tick_times.size() > 1
+          ? double(tick_times.back() - tick_times.front()) / 1e9
+          : 0;
+
+  out << "{\"name\":\"" << workload.name << "\",\"tickers\":" << count
+      << ",\"ticks\":" << intervals.size() << ",\"achieved_tickrate\":"
+      << (measured_seconds > 0 ? double(intervals.size()) / measured_seconds
+                               : 0)
+      << ",\"updates_per_second\":" << double(updates) * 1e9 / double(duration)
+      << ",\"tick_interval\":";
+  WriteDistribution(out, intervals);
+  out << ",\"tick_jitter\":";
+  WriteDistribution(out, jitter);
+
+  out << ",\"threads\":[";
+  double barrier_total = 0;
+  for (size_t i = 0; i < stats_after.size(); i++) {
+    const uint64_t ticks = stats_after[i].ticks - stats_before[i].ticks;
+    const uint64_t busy = stats_after[i].busy_ns - stats_before[i].busy_ns;
+    const uint64_t barrier =
+        stats_after[i].barrier_ns - stats_before[i].barrier_ns;
+    const double barrier_per_tick =
+        ticks == 0 ? 0 : double(barrier) / double(ticks);
+    barrier_total += barrier_per_tick;
+    out << (i == 0 ? "" : ",") << "{\"ticks\":" << ticks
+        << ",\"utilisation\":" << double(busy) / double(duration)
+        << ",\"busy_ns_per_tick\":"
+        << (ticks == 0 ? 0 : double(busy) / double(ticks))
+        << ",\"barrier_ns_per_tick\":" << barrier_per_tick << "}";
+  }
+  // includes the wait for the next tick, which is zero if unpaced
+  out << "],\"barrier_ns_per_tick\":"
+      << barrier_total / double(std::max<size_t>(stats_after.size(), 1))
+      << ",\"migrations\":"
+      << migrations_after.migrations - migrations_before.migrations
+      << ",\"imbalance_before\":" << migrations_after.imbalance_before
+      << ",\"imbalance_after\":" << migrations_after.imbalance_after
+      << ",\"overrun_ticks\":"
+      << overload_after.overrun_ticks - overload_before.overrun_ticks
+      << ",\"degraded_ticks\":"
+      << overload_after.degraded_ticks - overload_before.degraded_ticks
+      << ",\"skipped_updates\":"
+      << overload_after.skipped_updates - overload_before.skipped_updates
+      << ",\"overload_level\":" << overload_after.level << "}";
+
+  tickers.clear();
+  spin_batch.reset();
+  probe.reset();
+  // removed objects are released at the beginning of the next ticks
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+  const uint64_t work_ns =
+      argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000;
+  const double seconds = argc > 3 ? std::strtod(argv[3], nullptr) : 3;
+  const bool unpaced = argc > 4 && std::strcmp(argv[4], "unpaced") == 0;
+
+  std::shared_ptr<Core> core = Core::GetInstance();
+  if (unpaced) {
+    core->pacer().SetMode(engine::core::TickPacer::Mode::kUnpaced);
+  }
+
+  static constexpr Workload kWorkloads[] = {
+      {"uniform", EveryTick, false, false, false, false},
+      {"heavy_tailed", EveryTick, true, false, false, false},
+      {"mixed", MixedTickrate, false, false, false, false},
+      {"pinned", EveryTick, false, true, false, false},
+      {"low_priority", EveryTick, false, false, true, false},
+      {"batch", EveryTick, false, false, false, true},
+  };
+
+  std::cout << std::boolalpha << "{\"threads\":" << core->thread_ids().size()
+            << ",\"target_tickrate\":" << core->tickrate()
+            << ",\"pin_threads\":" << core->config().pin_threads
+            << ",\"numa_local\":" << core->config().numa_local
+            << ",\"unpaced\":" << (unpaced ? "true" : "false")
+            << ",\"clock\":" << int(Clock::source()) << ",\"workloads\":[";
+  for (size_t i = 0; i < std::size(kWorkloads); i++) {
+    std::cout << (i == 0 ? "" : ",");
+    RunWorkload(std::cout, *core, kWorkloads[i], count, work_ns, seconds);
+  }
+  std::cout << "],\"pacer\":";
+  core->pacer().WriteJson(std::cout);
+  std::cout << "}" << std::endl;
+
+  core.reset();
+  Core::Shutdown();
+  return 0;
+}
@@ -0,0 +1,132 @@
+// Compares the cost of finding due tickers with a flat list, where every
+// ticker is visited each tick, against TickSchedule buckets.
+// Tickers do no work in Update, so the result is the scheduling overhead.
+// Buckets are measured twice: with every offset set to zero, the way tickers
+// were scheduled before, and with automatic offsets. The peak amount of
+// updates per tick shows how flat the load is.
+//
+// usage: schedulerBench [tickers] [ticks]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "engine/Ticker.h"
+#include "engine/core/TickSchedule.h"
+
+namespace {
+class EmptyTicker : public engine::core::Ticker {
+ public:
+  EmptyTicker(uint32_t tickrate, uint32_t offset) : Ticker(tickrate) {
+    SetTickOffset(offset);
+  }
+  void Update(const uint64_t) override { updates_++; }
+  [[nodiscard]] uint64_t updates() const noexcept { return updates_; }
+
+ private:
+  uint64_t updates_ = 0;
+};
+
+// Mostly low frequency objects, like in a big world: 5% every tick, the rest
+// spread between 2..64 ticks
+uint32_t MixedTickrate(size_t index) {
+  static constexpr uint32_t kTickrates[] = {1, 2, 4, 8, 8, 16, 16,
+                                            16, 32, 32, 32, 64, 64, 64,
+                                            64, 64, 64, 64, 64, 64};
+  return kTickrates[index % std::size(kTickrates)];
+}
+
+template <typename Function>
+double MeasureTicks(uint64_t ticks, Function&& tick_function) {
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t tick = 1; tick <= ticks; tick++) {
+    tick_function(tick);
+  }
+  auto duration = std::chrono::steady_clock::now() - start;
+  return double(std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+                    .count()) /
+         double(ticks);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+  const uint64_t ticks = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 640;
+
+  std::vector<std::shared_ptr<EmptyTicker>> tickers;
+  std::vector<std::weak_ptr<engine::core::Ticker>> flat;
+  engine::core::TickSchedule zero_schedule;
+  engine::core::TickSchedule schedule;
+  auto add = [&tickers](engine::core::TickSchedule& to, uint32_t tickrate,
+                        uint32_t offset) {
+    tickers.push_back(std::make_shared<EmptyTicker>(tickrate, offset));
+    to.Add(tickers.back().get(), tickrate, offset);
+  };
+  for (size_t i = 0; i < count; i++) {
+    add(zero_schedule, MixedTickrate(i), 0);
+    flat.push_back(tickers.back());
+    add(schedule, MixedTickrate(i), engine::core::Ticker::kAutoTickOffset);
+  }
+
+  // the way Core visited objects before: lock every object and check the
+  // tickrate
+  uint64_t flat_visits = 0;
+  double flat_ns = MeasureTicks(ticks, [&](uint64_t tick) {
+    for (auto& weak_object : flat) {
+      flat_visits++;
+      auto object = weak_object.lock();
+      if (object != nullptr && tick % object->tickrate() == 0) {
+        object->UpdateExecutionTime(tick);
+      }
+    }
+  });
+
+  struct BucketResult {
+    double ns_per_tick;
+    uint64_t visits = 0;
+    uint64_t peak_visits = 0;
+  };
+  auto run_buckets = [&](engine::core::TickSchedule& tested) {
+    BucketResult result;
+    result.ns_per_tick = MeasureTicks(ticks, [&](uint64_t tick) {
+      uint64_t visits = 0;
+      tested.ForEachDue(tick, [&](engine::core::TickSchedule::Bucket& bucket) {
+        for (engine::core::Ticker* object : bucket.objects) {
+          visits++;
+          object->UpdateExecutionTime(tick);
+        }
+      });
+      result.visits += visits;
+      result.peak_visits = std::max(result.peak_visits, visits);
+    });
+    return result;
+  };
+  const BucketResult zero = run_buckets(zero_schedule);
+  const BucketResult automatic = run_buckets(schedule);
+
+  // updates done by the automatic offset schedule, the zero offset tickers are
+  // updated by both the flat list and their schedule
+  uint64_t updates = 0;
+  for (auto& ticker : tickers) {
+    if (ticker->tick_offset() == engine::core::Ticker::kAutoTickOffset) {
+      updates += ticker->updates();
+    }
+  }
+  std::printf("{\"tickers\":%zu,\"ticks\":%llu,\"updates\":%llu,\n", count,
+              (unsigned long long)ticks, (unsigned long long)updates);
+  std::printf(" \"flat\":{\"ns_per_tick\":%.1f,\"visits_per_tick\":%.1f},\n",
+              flat_ns, double(flat_visits) / double(ticks));
+  auto print_buckets = [ticks](const char* name, BucketResult const& result,
+                               const char* separator) {
+    std::printf(
+        " \"%s\":{\"ns_per_tick\":%.1f,\"visits_per_tick\":%.1f,"
+        "\"peak_visits_per_tick\":%llu}%s\n",
+        name, result.ns_per_tick, double(result.visits) / double(ticks),
+        (unsigned long long)result.peak_visits, separator);
+  };
+  print_buckets("buckets_zero_offset", zero, ",");
+  print_buckets("buckets_auto_offset", automatic, "}");
+  return 0;
+}
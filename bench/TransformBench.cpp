@@ -0,0 +1,175 @@
+// Compares building model matrices per object with glm, the way Object did
+// before the TransformStore, against every TransformKernel path the CPU
+// supports, for growing amounts of objects.
+// "glm_matrices" multiplies the stored translation, rotation and scale
+// matrices, "glm" builds them from the components first. Each measurement is
+// the fastest of several repetitions, in nanoseconds per matrix.
+// "store" writes the position of every transform of a TransformStore and
+// rebuilds the dirty matrices, the way objects moving each tick do.
+//
+// usage: transformBench [repetitions] [counts...]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "engine/core/TransformKernel.h"
+#include "engine/core/TransformStore.h"
+
+namespace {
+using engine::core::SimdLevel;
+using engine::core::TransformKernel;
+
+struct Transforms {
+  std::vector<float> position_x, position_y, position_z;
+  std::vector<float> rotation_x, rotation_y, rotation_z, rotation_w;
+  std::vector<float> scale_x, scale_y, scale_z;
+
+  explicit Transforms(size_t count) {
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> position(-100.0F, 100.0F);
+    std::uniform_real_distribution<float> unit(-1.0F, 1.0F);
+    std::uniform_real_distribution<float> scale(0.1F, 4.0F);
+    for (size_t i = 0; i < count; i++) {
+      position_x.push_back(position(random));
+      position_y.push_back(position(random));
+      position_z.push_back(position(random));
+      const glm::quat rotation = glm::normalize(glm::quat(
+          unit(random), unit(random), unit(random), unit(random) + 2.0F));
+      rotation_x.push_back(rotation.x);
+      rotation_y.push_back(rotation.y);
+      rotation_z.push_back(rotation.z);
+      rotation_w.push_back(rotation.w);
+      scale_x.push_back(scale(random));
+      scale_y.push_back(scale(random));
+      scale_z.push_back(scale(random));
+    }
+  }
+
+  [[nodiscard]] engine::core::TransformArrays arrays() const {
+    return {position_x.data(), position_y.data(), position_z.data(),
+            rotation_x.data(), rotation_y.data(), rotation_z.data(),
+            rotation_w.data(), scale_x.data(),    scale_y.data(),
+            scale_z.data()};
+  }
+  [[nodiscard]] glm::vec3 position(size_t i) const {
+    return {position_x[i], position_y[i], position_z[i]};
+  }
+  [[nodiscard]] glm::quat rotation(size_t i) const {
+    return {rotation_w[i], rotation_x[i], rotation_y[i], rotation_z[i]};
+  }
+  [[nodiscard]] glm::vec3 scale(size_t i) const {
+    return {scale_x[i], scale_y[i], scale_z[i]};
+  }
+};
+
+// Fastest of the repetitions in nanoseconds per matrix.
+template <typename Function>
+double Measure(uint32_t repetitions, size_t count, Function&& function) {
+  double best = 0;
+  for (uint32_t i = 0; i < repetitions; i++) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto duration = std::chrono::steady_clock::now() - start;
+    const double ns =
+        double(std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+                   .count()) /
+        double(count);
+    best = i == 0 ? ns : std::min(best, ns);
+  }
+  return best;
+}
+
+// Keeps the results alive so the loops aren't optimised away.
+float Checksum(std::vector<glm::mat4> const& matrices) {
+  float sum = 0;
+  for (size_t i = 0; i < matrices.size(); i += 97) {
+    sum += matrices[i][0][0] + matrices[i][3][2];
+  }
+  return sum;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  const uint32_t repetitions =
+      argc > 1 ? uint32_t(std::strtoul(argv[1], nullptr, 10)) : 10;
+  std::vector<size_t> counts;
+  for (int i = 2; i < argc; i++) {
+    counts.push_back(std::strtoull(argv[i], nullptr, 10));
+  }
+  if (counts.empty()) {
+    counts = {10000, 100000, 1000000};
+  }
+
+  float checksum = 0;
+  std::printf(
+      "{\"supported\":\"%s\",\"default\":\"%s\",\"repetitions\":%u,"
+      "\"results\":[\n",
+      TransformKernel::name(TransformKernel::supported_level()),
+      TransformKernel::name(TransformKernel::level()), repetitions);
+  for (size_t c = 0; c < counts.size(); c++) {
+    const size_t count = counts[c];
+    const Transforms transforms(count);
+    std::vector<glm::mat4> out(count);
+
+    std::vector<glm::mat4> translation(count);
+    std::vector<glm::mat4> rotation(count);
+    std::vector<glm::mat4> scale(count);
+    for (size_t i = 0; i < count; i++) {
+      translation[i] = glm::translate(glm::mat4(1.0F), transforms.position(i));
+      rotation[i] = glm::mat4_cast(transforms.rotation(i));
+      scale[i] = glm::scale(glm::mat4(1.0F), transforms.scale(i));
+    }
+    const double glm_matrices_ns = Measure(repetitions, count, [&]() {
+      for (size_t i = 0; i < count; i++) {
+        out[i] = translation[i] * rotation[i] * scale[i];
+      }
+    });
+    checksum += Checksum(out);
+    const double glm_ns = Measure(repetitions, count, [&]() {
+      for (size_t i = 0; i < count; i++) {
+        out[i] = glm::translate(glm::mat4(1.0F), transforms.position(i)) *
+                 glm::mat4_cast(transforms.rotation(i)) *
+                 glm::scale(glm::mat4(1.0F), transforms.scale(i));
+      }
+    });
+    checksum += Checksum(out);
+
+    std::printf(" {\"objects\":%zu,\"glm_matrices_ns\":%.2f,\"glm_ns\":%.2f",
+                count, glm_matrices_ns, glm_ns);
+    const engine::core::TransformArrays arrays = transforms.arrays();
+    for (auto level : {SimdLevel::kScalar, SimdLevel::kSse, SimdLevel::kAvx2,
+                       SimdLevel::kAvx512}) {
+      const TransformKernel::Function function =
+          TransformKernel::function(level);
+      if (function == nullptr) {
+        continue;
+      }
+      const double ns = Measure(repetitions, count,
+                                [&]() { function(arrays, count, out.data()); });
+      checksum += Checksum(out);
+      std::printf(",\"%s_ns\":%.2f", TransformKernel::name(level), ns);
+    }
+
+    engine::core::TransformStore store;
+    std::vector<engine::core::TransformHandle> handles;
+    for (size_t i = 0; i < count; i++) {
+      handles.push_back(store.Add(transforms.position(i),
+                                  transforms.rotation(i), transforms.scale(i)));
+    }
+    const double store_ns = Measure(repetitions, count, [&]() {
+      for (auto handle : handles) {
+        store.SetPosition(handle, store.position(handle));
+      }
+      store.UpdateModelMatrices();
+    });
+    std::printf(",\"store_ns\":%.2f}%s\n", store_ns,
+                c + 1 == counts.size() ? "" : ",");
+  }
+  std::printf("],\"checksum\":%.1f}\n", double(checksum));
+  return 0;
+}
@@ -19,6 +19,10 @@
 
 #include "content/code/Objects/Fractal.h"
 #include "engine/Core.h"
+#include "engine/HierarchyTicker.h"
+#include "engine/SnapshotTicker.h"
+#include "engine/core/RenderSnapshots.h"
+#include "engine/core/Trace.h"
 
 /*
 #ifdef WIN32
@@ -59,6 +63,15 @@ int main() {
 
   auto core = engine::core::Core::GetInstance();
   core->AddTickingObject(window);
+  // world matrices of objects with parents
+  auto hierarchy_ticker = std::make_shared<engine::core::HierarchyTicker>();
+  core->AddTickingObject(hierarchy_ticker);
+  // world matrices for the render thread, captured after the hierarchy
+  const engine::core::PhaseId snapshot_phase = core->DeclarePhase(
+      "Snapshot", {engine::core::phase::kPostUpdate});
+  auto snapshot_ticker =
+      std::make_shared<engine::core::SnapshotTicker>(snapshot_phase);
+  core->AddTickingObject(snapshot_ticker);
   engine::client::Player player(window, glm::vec3(0, 1, 0));
 
   window->SwapInterval(1);
@@ -92,7 +105,9 @@ int main() {
     }
   };
 
+  ENGINE_TRACE_THREAD_NAME("Render");
   while (!window->ShouldClose()) {
+    ENGINE_TRACE_SCOPE("Frame");
     shader_update_lambda();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
     glClearColor(0.1F, 0.1F, 0.15F, 1.0F);
@@ -104,13 +119,30 @@ int main() {
     shader.lock()->Use();
     shader.lock()->SetMat4("fullMatrix", matrix);
     shader.lock()->SetFloat("time", (float)glfwGetTime());
-    renderer->Draw(f);
-    window->SwapBuffers();
-    window->PollEvents();
-    double t = abs(player.position().z -  f->position().z);
+    {
+      // the frame draws the state of one tick, the objects keep moving
+      ENGINE_TRACE_SCOPE("AcquireSnapshot");
+      engine::core::RenderSnapshots::Global().Acquire();
+    }
+    {
+      ENGINE_TRACE_SCOPE("Draw");
+      renderer->Draw(f);
+    }
+    {
+      ENGINE_TRACE_SCOPE("SwapBuffers");
+      window->SwapBuffers();
+    }
+    {
+      ENGINE_TRACE_SCOPE("PollEvents");
+      window->PollEvents();
+    }
+    double t = abs(player.position().z - f->snapshot_matrix()[3].z);
     double u = log1p(t);
     player.SetVelocity((float)u);
   }
+#ifdef ENGINE_TRACE
+  engine::core::Trace::WriteFile("engine_trace.json");
+#endif
 }
 /*
 uniform mat4 model;
@@ -32,7 +32,7 @@ class FractalRenderer : public engine::client::render::Renderer {
   }
 
   void Draw(std::weak_ptr<engine::core::Object> object) override {
-    fractal_shader_->SetMat4("model", object.lock().get()->model_matrix());
+    fractal_shader_->SetMat4("model", object.lock().get()->snapshot_matrix());
     mesh_->Draw(fractal_shader_);
   }
 
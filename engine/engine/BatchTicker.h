@@ -0,0 +1,139 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <span>
+#include <vector>
+
+#include "Ticker.h"
+
+namespace engine::core {
+/// <summary>
+/// Ticker which updates many instances of the same system at once.
+/// Instead of one virtual Update per instance, the Core splits the batch
+/// into contiguous chunks and updates them on all update threads in
+/// parallel, so every chunk is a tight loop over the same type.
+///
+/// Chunks are multiples of kChunkAlignment instances, except the last one,
+/// so vectorised loops have no remainder in the middle of the batch.
+/// If the batch is bound to a thread, or the Core is deterministic and
+/// doesn't steal jobs, chunks are updated by one thread.
+///
+/// latency() and average_update_time() are the sum of the chunk times, i.e.
+/// the CPU time of the whole batch.
+/// </summary>
+class BatchTickerBase : public Ticker {
+ public:
+  static constexpr size_t kChunkAlignment = 16;
+  // Chunks are at least this long, unless SetGrain says otherwise, so the
+  // cost of a job is spread over enough instances.
+  static constexpr size_t kMinChunkSize = 256;
+
+  explicit BatchTickerBase(const uint32_t tickrate) : Ticker(tickrate) {
+    batched_ = true;
+  }
+  BatchTickerBase(const uint32_t tickrate, std::thread::id const& thread_id)
+      : Ticker(tickrate, thread_id) {
+    batched_ = true;
+  }
+
+  // Amount of instances. Should change only in PrepareBatch or while the
+  // batch isn't updated.
+  [[nodiscard]] virtual size_t batch_size() const noexcept = 0;
+
+  // Instances per chunk, zero lets the Core choose.
+  [[nodiscard]] size_t grain() const noexcept { return grain_; }
+
+  // Updates the whole batch in the calling thread.
+  void Update(const uint64_t tick) final {
+    PrepareBatch(tick);
+    UpdateRange(tick, 0, batch_size());
+  }
+
+ protected:
+  // Called once per update by one thread before the batch is split, e.g. to
+  // add or remove instances.
+  virtual void PrepareBatch(const uint64_t /*tick*/) {}
+
+  // Updates instances [begin, end). Called concurrently for disjoint ranges.
+  virtual void UpdateRange(uint64_t tick, size_t begin, size_t end) = 0;
+
+  void SetGrain(size_t grain) noexcept { grain_ = grain; }
+
+ private:
+  friend class Core;
+
+  // Returns the size of the chunks the batch should be split into, and
+  // expects that many calls of RunChunk.
+  size_t BeginChunks(const uint64_t tick, size_t workers) {
+    PrepareBatch(tick);
+    const size_t size = batch_size();
+    size_t chunk = grain_;
+    if (chunk == 0) {
+      // parenthesised, so the max macro of Windows.h doesn't expand
+      chunk = (std::max)(kMinChunkSize, (size + workers - 1) / workers);
+      chunk = (chunk + kChunkAlignment - 1) / kChunkAlignment *
+              kChunkAlignment;
+    }
+    batch_ns_.store(0, std::memory_order_relaxed);
+    pending_chunks_.store((size + chunk - 1) / chunk,
+                          std::memory_order_relaxed);
+    return chunk;
+  }
+
+  // Returns the time the chunk took. The last chunk records the time of the
+  // whole batch.
+  uint64_t RunChunk(const uint64_t tick, size_t begin, size_t end) {
+    const uint64_t start = Clock::now_ns();
+    UpdateRange(tick, begin, end);
+    const uint64_t finish = Clock::now_ns();
+    ENGINE_TRACE_RECORD("BatchTicker::UpdateRange", start, finish);
+    const uint64_t total =
+        batch_ns_.fetch_add(finish - start, std::memory_order_relaxed) +
+        finish - start;
+    if (pending_chunks_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      RecordExecutionTime(total, finish);
+    }
+    return finish - start;
+  }
+
+  size_t grain_ = 0;
+  std::atomic<size_t> pending_chunks_ = 0;
+  std::atomic<uint64_t> batch_ns_ = 0;
+};
+
+/// <summary>
+/// BatchTicker which owns its instances in a contiguous vector.
+/// UpdateChunk receives a span of them:
+///
+///   class Particles : public BatchTicker<Particle> {
+///     void UpdateChunk(uint64_t, std::span<Particle> chunk) override {
+///       for (Particle& p : chunk) { p.position += p.velocity * dt; }
+///     }
+///   };
+/// </summary>
+template <typename T>
+class BatchTicker : public BatchTickerBase {
+ public:
+  using BatchTickerBase::BatchTickerBase;
+
+  [[nodiscard]] size_t batch_size() const noexcept final {
+    return items_.size();
+  }
+
+  // Should be changed only in PrepareBatch or while the batch isn't updated.
+  [[nodiscard]] std::vector<T>& items() noexcept { return items_; }
+  [[nodiscard]] std::vector<T> const& items() const noexcept {
+    return items_;
+  }
+
+ protected:
+  virtual void UpdateChunk(uint64_t tick, std::span<T> chunk) = 0;
+
+ private:
+  void UpdateRange(uint64_t tick, size_t begin, size_t end) final {
+    UpdateChunk(tick, std::span<T>(items_).subspan(begin, end - begin));
+  }
+
+  std::vector<T> items_;
+};
+}  // namespace engine::core
@@ -1,57 +1,181 @@
 #include "Core.h"
+
+#include "engine/core/CpuTopology.h"
+
+#include <bit>
+#include <cmath>
+
 namespace engine::core {
 
+thread_local Core* Core::current_ = nullptr;
+std::atomic<Core*> Core::instance_ = nullptr;
 std::shared_ptr<Core> Core::core_ptr_ = std::shared_ptr<Core>(nullptr);
 std::mutex Core::core_creation_mutex_;
+CoreConfig Core::pending_config_;
+
+Core& Core::Current() noexcept {
+  return current_ != nullptr ? *current_
+                             : *instance_.load(std::memory_order_acquire);
+}
 
 std::shared_ptr<Core> Core::GetInstance() noexcept {
+  std::scoped_lock<std::mutex> lock(core_creation_mutex_);
   if (core_ptr_ == nullptr) {
-    if (core_creation_mutex_.try_lock()) {
-      core_ptr_ = std::shared_ptr<Core>(new Core());
-      core_creation_mutex_.unlock();
-    } else {
-      core_creation_mutex_.lock();
-      core_creation_mutex_.unlock();
+    CoreConfig config = pending_config_;
+    // invalid settings are skipped
+    config.LoadEnvironment();
+    if (!config.Valid()) {
+      config.reserved_cpus.clear();
     }
+    core_ptr_ = std::shared_ptr<Core>(new Core(std::move(config)));
+    instance_.store(core_ptr_.get(), std::memory_order_release);
   }
   return core_ptr_;
 }
 
-double Core::time() {
-  std::chrono::time_point<std::chrono::system_clock> now =
-      std::chrono::system_clock::now();
-  double microseconds =
-      (double)std::chrono::duration_cast<std::chrono::microseconds>(
-          now.time_since_epoch())
-          .count();
-  return microseconds / 1e6;
+std::shared_ptr<Core> Core::Create(CoreConfig config) {
+  if (!config.Valid()) {
+    return nullptr;
+  }
+  return std::shared_ptr<Core>(new Core(std::move(config)));
+}
+
+void Core::Shutdown() {
+  std::shared_ptr<Core> core;
+  {
+    std::scoped_lock<std::mutex> lock(core_creation_mutex_);
+    instance_.store(nullptr, std::memory_order_release);
+    core = std::move(core_ptr_);
+  }
+  // destroyed outside of the lock, if nobody else holds it
+  if (core != nullptr) {
+    core->Stop();
+  }
+}
+
+bool Core::Configure(CoreConfig config) {
+  std::scoped_lock<std::mutex> lock(core_creation_mutex_);
+  if (core_ptr_ != nullptr || !config.Valid()) {
+    return false;
+  }
+  pending_config_ = std::move(config);
+  return true;
+}
+
+uint32_t Core::ThreadCount(CoreConfig const& config) {
+  if (config.threads != 0) {
+    return config.threads;
+  }
+  const uint32_t cpus = CpuTopology::cpu_count();
+  const auto reserved = uint32_t(std::count_if(
+      config.reserved_cpus.begin(), config.reserved_cpus.end(),
+      [cpus](uint32_t cpu) { return cpu < cpus; }));
+  return std::max(1U, cpus - std::min(cpus, reserved));
+}
+
+std::vector<uint32_t> Core::WorkerCpus() const {
+  if (!config_.pin_threads && !config_.numa_local) {
+    return {};
+  }
+  std::vector<uint32_t> cpus;
+  for (uint32_t cpu : CpuTopology::current_affinity()) {
+    if (!std::binary_search(config_.reserved_cpus.begin(),
+                            config_.reserved_cpus.end(), cpu)) {
+      cpus.push_back(cpu);
+    }
+  }
+  if (cpus.empty()) {  // everything is reserved
+    cpus = CpuTopology::current_affinity();
+  }
+  if (config_.numa_local) {
+    // threads fill a node before going to the next one, so a small pool
+    // doesn't share its data across sockets
+    std::vector<std::pair<uint32_t, uint32_t>> nodes;
+    for (uint32_t cpu : cpus) {
+      nodes.emplace_back(CpuTopology::numa_node(cpu), cpu);
+    }
+    std::sort(nodes.begin(), nodes.end());
+    for (size_t i = 0; i < cpus.size(); i++) {
+      cpus[i] = nodes[i].second;
+    }
+  }
+  return cpus;
 }
 
-uint64_t Core::global_tick() noexcept { return core_ptr_->global_tick_; }
+double Core::time() { return Clock::now_seconds(); }
+
+uint64_t Core::tick_time_ns() noexcept {
+  return Current().last_tick_timestamp_.load(std::memory_order_relaxed);
+}
+
+uint64_t Core::global_tick() noexcept { return Current().tick(); }
 
 uint32_t Core::CalcTickrate(uint32_t times_per_second) {
-  return (uint32_t)ceil(double(core_ptr_->tickrate_) / times_per_second);
+  return (uint32_t)ceil(double(Current().tickrate()) / times_per_second);
 }
 
-double Core::tick_delta() { return core_ptr_->last_tick_timedelta_; }
+bool Core::SetTickrate(uint32_t tickrate) noexcept {
+  if (tickrate == 0 || tickrate > CoreConfig::kMaxTickrate) {
+    return false;
+  }
+  tickrate_requested_.store(tickrate, std::memory_order_relaxed);
+  return true;
+}
 
-int Core::AddTickingObject(std::weak_ptr<Ticker> object) {
-  auto temp = object.lock();
-  if (temp == nullptr || threads_.empty()) {
+double Core::interpolation_alpha() noexcept {
+  Core const& core = Current();
+  const uint64_t start =
+      core.last_tick_wall_ns_.load(std::memory_order_relaxed);
+  const uint64_t now = Clock::now_ns();
+  if (now <= start) {
     return 0;
   }
-  std::scoped_lock<std::mutex> lock(threads_mutex_);
+  const double step = 1e9 / double(core.tickrate());
+  return std::min(double(now - start) / step, 1.0);
+}
 
-  // add object thread with desired id
-  if (!temp->thread_id().expired()) {
-    auto k = temp->thread_id().lock();
+double Core::tick_delta() { return double(tick_delta_ns()) / 1e9; }
+
+uint64_t Core::tick_delta_ns() noexcept {
+  return Current().last_tick_timedelta_.load(std::memory_order_relaxed);
+}
 
+bool Core::SetDeterministic(bool deterministic) noexcept {
+  // objects which were spread between the threads would stay there
+  if (deterministic &&
+      !deterministic_requested_.load(std::memory_order_relaxed) &&
+      has_objects_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  deterministic_requested_.store(deterministic, std::memory_order_relaxed);
+  return true;
+}
+
+bool Core::deterministic() const noexcept {
+  return deterministic_requested_.load(std::memory_order_relaxed);
+}
+
+void Core::SetOverloadControl(bool enabled) noexcept {
+  overload_control_.store(enabled, std::memory_order_relaxed);
+}
+
+bool Core::overload_control() const noexcept {
+  return overload_control_.load(std::memory_order_relaxed);
+}
+
+Core::UpdateThread* Core::ChooseThread(Ticker const& object) const {
+  // add object thread with desired id
+  if (auto k = object.thread_id().lock(); k != nullptr) {
     auto t = std::find_if(std::begin(threads_), std::end(threads_),
                           [&k](std::unique_ptr<UpdateThread> const& thread) {
                             return *k == thread->thread_id();
                           });
-    t->get()->AddObject(object);
-    return 1;
+    return t == std::end(threads_) ? nullptr : t->get();
+  }
+
+  // one thread keeps the update order stable
+  if (deterministic()) {
+    return threads_.front().get();
   }
 
   // search for the thread with minimum execution time
@@ -61,93 +185,775 @@ int Core::AddTickingObject(std::weak_ptr<Ticker> object) {
       min_execution_thread = i;
     }
   }
-  min_execution_thread->get()->AddObject(object);
+  return min_execution_thread->get();
+}
 
+int Core::AddTickingObject(std::shared_ptr<Ticker> object) {
+  if (object == nullptr || threads_.empty() ||
+      object->phase() >=
+          declared_phase_count_.load(std::memory_order_acquire)) {
+    return 0;
+  }
+  UpdateThread* thread = ChooseThread(*object);
+  if (thread == nullptr) {
+    return 0;
+  }
+  object->owner_thread_.store(uint32_t(thread->index_),
+                              std::memory_order_relaxed);
+  has_objects_.store(true, std::memory_order_relaxed);
+  thread->AddObject(std::move(object));
   return 1;
 }
 
-std::chrono::nanoseconds Core::calc_overhead() {
-  using namespace std::chrono;
-  constexpr size_t tests = 1001;
-  constexpr auto timer = 200us;
-
-  std::condition_variable t;
-  auto init = [&timer, &t]() {
-    auto end = steady_clock::now() + timer;
-    while (steady_clock::now() < end);
-    time();
-    t.notify_all();
-  };
+size_t Core::AddTickingObjects(
+    std::span<const std::shared_ptr<Ticker>> objects) {
+  if (threads_.empty()) {
+    return 0;
+  }
+  // Execution time of threads doesn't change during the call, so instead of
+  // searching for the minimum for every object we spread them evenly starting
+  // from the least loaded thread.
+  std::vector<UpdateThread*> order;
+  order.reserve(threads_.size());
+  for (auto& thread : threads_) {
+    order.push_back(thread.get());
+  }
+  std::sort(order.begin(), order.end(),
+            [](UpdateThread const* a, UpdateThread const* b) {
+              return a->exec_time() < b->exec_time();
+            });
+
+  const size_t phase_count =
+      declared_phase_count_.load(std::memory_order_acquire);
+  size_t added = 0;
+  size_t next = 0;
+  for (auto const& object : objects) {
+    if (object == nullptr || object->phase() >= phase_count) {
+      continue;
+    }
+    UpdateThread* thread =
+        object->thread_id().expired() && !deterministic()
+            ? order[next++ % order.size()]
+            : ChooseThread(*object);
+    if (thread == nullptr) {
+      continue;
+    }
+    object->owner_thread_.store(uint32_t(thread->index_),
+                                std::memory_order_relaxed);
+    has_objects_.store(true, std::memory_order_relaxed);
+    thread->AddObject(object);
+    added++;
+  }
+  return added;
+}
+
+bool Core::Spawn(TickTask task, PhaseId phase) {
+  if (!task.valid() || task.handle_.done() || threads_.empty() ||
+      phase >= declared_phase_count_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  // tasks are cheap to keep, so they are just spread round robin, or kept
+  // on the first thread like the other unbound work in the deterministic mode
+  const size_t index =
+      deterministic()
+          ? 0
+          : next_task_thread_.fetch_add(1, std::memory_order_relaxed) %
+                threads_.size();
+  TickTask::Handle handle = std::exchange(task.handle_, {});
+  TickTask::promise_type& promise = handle.promise();
+  promise.core_ = this;
+  promise.thread_ = uint32_t(index);
+  promise.phase_ = phase;
+  promise.root_ = handle;
+  task_count_.fetch_add(1, std::memory_order_relaxed);
+  has_objects_.store(true, std::memory_order_relaxed);
+  threads_[index]->PostTask(handle);
+  return true;
+}
+
+void TickTask::promise_type::ResumeAfter(uint64_t ticks) {
+  core_->SuspendTask(Handle::from_promise(*this), ticks);
+}
 
-  time_point<steady_clock> start;
-  nanoseconds dur[tests];
+void TickTask::promise_type::ResumeAfterJob(std::function<void()> job) {
+  core_->SuspendTask(Handle::from_promise(*this), std::move(job));
+}
+
+void Core::SuspendTask(TickTask::Handle handle, uint64_t ticks) {
+  // the task runs on its own thread, so the queue is touched only by it
+  UpdateThread& thread = *threads_[handle.promise().thread_];
+  thread.ScheduleTask(handle, thread.task_tick_ + ticks);
+}
+
+void Core::SuspendTask(TickTask::Handle handle, std::function<void()> job) {
+  UpdateThread* thread = threads_[handle.promise().thread_].get();
+  const bool submitted = background_.Submit(
+      [thread, handle, job = std::move(job)](bool cancelled) {
+        // a cancelled task is destroyed with the other tasks of the thread
+        if (!cancelled) {
+          job();
+        }
+        thread->PostTask(handle);
+      });
+  if (!submitted) {
+    thread->PostTask(handle);
+  }
+}
+
+void Core::RemoveTickingObject(std::shared_ptr<Ticker> const& object) {
+  if (object == nullptr) {
+    return;
+  }
+  const uint32_t owner = object->owner_thread_.load(std::memory_order_relaxed);
+  if (owner < threads_.size()) {
+    threads_[owner]->RemoveObject(object);
+  }
+}
+
+std::vector<Core::TickerLatency> Core::SlowestTickers(size_t count) {
+  std::vector<TickerLatency> result;
+  for (auto& thread : threads_) {
+    std::scoped_lock<std::mutex> lock(thread->latency_report_mutex_);
+    result.insert(result.end(), thread->latency_report_.begin(),
+                  thread->latency_report_.end());
+  }
+  std::sort(result.begin(), result.end(),
+            [](TickerLatency const& a, TickerLatency const& b) {
+              return a.stats.p99_ns > b.stats.p99_ns;
+            });
+  result.resize(std::min(result.size(), count));
+  return result;
+}
+
+void Core::WriteLatencyJson(std::ostream& out, size_t count) {
+  out << "{\"threads\":[";
+  for (size_t i = 0; i < threads_.size(); i++) {
+    out << (i == 0 ? "" : ",")
+        << "{\"exec_time\":" << threads_[i]->exec_time() << ",\"objects\":"
+        << threads_[i]->object_count_.load(std::memory_order_relaxed) << "}";
+  }
+  out << "],\"slowest\":[";
+  bool first = true;
+  for (auto const& ticker : SlowestTickers(count)) {
+    out << (first ? "" : ",") << "{\"thread\":" << ticker.thread
+        << ",\"handle\":[" << ticker.handle.index << ","
+        << ticker.handle.generation << "],\"phase\":" << int(ticker.phase)
+        << ",\"tickrate\":" << ticker.tickrate << ",\"latency\":";
+    ticker.stats.WriteJson(out);
+    out << "}";
+    first = false;
+  }
+  out << "]}";
+}
 
-  for (auto& d : dur) {
-    start = steady_clock::now();
-    init();
-    d = steady_clock::now() - start - timer;
+std::vector<std::thread::id> Core::thread_ids() const {
+  std::vector<std::thread::id> ids;
+  for (auto const& thread : threads_) {
+    ids.push_back(thread->thread_id());
   }
-  std::sort(std::begin(dur), std::end(dur));
-  return dur[tests / 2];
+  return ids;
 }
 
-inline void Core::busy_sleep(std::chrono::nanoseconds t) const {
-  auto end = std::chrono::steady_clock::now() + t - overhead_;
-  while (std::chrono::steady_clock::now() < end)
-    ;
+std::vector<Core::ThreadStats> Core::thread_stats() const {
+  std::vector<ThreadStats> stats;
+  for (auto const& thread : threads_) {
+    stats.push_back(
+        {thread->finished_ticks_.load(std::memory_order_relaxed),
+         thread->busy_ns_.load(std::memory_order_relaxed),
+         thread->barrier_ns_.load(std::memory_order_relaxed)});
+  }
+  return stats;
+}
+
+Core::MigrationStats Core::migration_stats() const noexcept {
+  return {rebalances_.load(std::memory_order_relaxed),
+          migrations_.load(std::memory_order_relaxed),
+          imbalance_before_.load(std::memory_order_relaxed),
+          imbalance_after_.load(std::memory_order_relaxed)};
 }
 
-void Core::ThreadReady(std::thread::id id) {
-  std::unique_lock lock(sync_mutex_);
+Core::OverloadStats Core::overload_stats() const {
+  uint64_t skipped = 0;
+  for (auto const& thread : threads_) {
+    skipped += thread->skipped_updates_.load(std::memory_order_relaxed);
+  }
+  return {overrun_ticks_.load(std::memory_order_relaxed),
+          degraded_ticks_.load(std::memory_order_relaxed), skipped,
+          overload_level_.load(std::memory_order_relaxed),
+          max_overrun_ns_.load(std::memory_order_relaxed)};
+}
 
-  if (operational_thread_id_ != id) {
-    sync_threads_ += 1;
-    sync_var_.wait(lock);
+void Core::UpdateOverloadLevel(uint64_t work_ns, uint64_t budget_ns) {
+  const bool enabled =
+      overload_control() && !deterministic_ &&
+      pacer_.mode() != TickPacer::Mode::kUnpaced &&
+      tick_limit_.load(std::memory_order_relaxed) == kFreeRunning;
+  uint32_t level = overload_level_.load(std::memory_order_relaxed);
+  if (!enabled) {
+    level = 0;
+    recovery_ticks_ = 0;
+  } else if (work_ns > budget_ns) {
+    overrun_ticks_.fetch_add(1, std::memory_order_relaxed);
+    if (work_ns - budget_ns > max_overrun_ns_.load(std::memory_order_relaxed)) {
+      max_overrun_ns_.store(work_ns - budget_ns, std::memory_order_relaxed);
+    }
+    level = std::min(level + 1, kMaxOverloadLevel);
+    recovery_ticks_ = 0;
+  } else if (level > 0 &&
+             double(work_ns) < double(budget_ns) * kRecoveryLoad) {
+    // one level at a time, the work grows back with every level
+    if (++recovery_ticks_ >= kRecoveryTicks) {
+      level--;
+      recovery_ticks_ = 0;
+    }
+  } else {
+    recovery_ticks_ = 0;
+  }
+  overload_level_.store(level, std::memory_order_relaxed);
+  if (level > 0) {
+    degraded_ticks_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+uint32_t Core::statistics_period() const noexcept {
+  // 4 times per second
+  return std::max(1U, (tickrate() + 3) / 4);
+}
+
+void Core::RebalanceThreads() {
+  std::vector<double> loads;
+  for (auto const& thread : threads_) {
+    loads.push_back(thread->exec_time());
+  }
+  auto imbalance = [&loads]() {
+    const double mean =
+        std::accumulate(loads.begin(), loads.end(), 0.0) / double(loads.size());
+    return mean > 0 ? *std::max_element(loads.begin(), loads.end()) / mean - 1
+                    : 0.0;
+  };
+  const double before = imbalance();
+  if (before > kMigrationStartImbalance) {
+    imbalanced_checks_++;
   } else {
-    lock.unlock();
-    while ((sync_threads_ + 1) < threads_.size()) {
-      std::this_thread::sleep_for(std::chrono::microseconds(1));
+    imbalanced_checks_ = 0;
+  }
+  if (imbalanced_checks_ >= kImbalancedChecks) {
+    rebalancing_ = true;
+  } else if (before < kMigrationStopImbalance) {
+    rebalancing_ = false;
+  }
+  if (!rebalancing_) {
+    return;
+  }
+
+  size_t migrations = 0;
+  while (migrations < kMaxMigrationsPerRebalance) {
+    const size_t from = size_t(
+        std::max_element(loads.begin(), loads.end()) - loads.begin());
+    const size_t to = size_t(
+        std::min_element(loads.begin(), loads.end()) - loads.begin());
+    // moving more than half of the gap would make the target the most loaded
+    // thread, and the object would be moved back
+    const double limit = (loads[from] - loads[to]) / 2;
+    auto& candidates = threads_[from]->migration_candidates_;
+    auto best = candidates.end();
+    for (auto i = candidates.begin(); i != candidates.end(); i++) {
+      if (i->object != nullptr && i->load > 0 && i->load <= limit &&
+          (best == candidates.end() || i->load > best->load)) {
+        best = i;
+      }
+    }
+    if (best == candidates.end()) {
+      break;
+    }
+    // each candidate is tried once
+    const MigrationCandidate candidate = *best;
+    best->object = nullptr;
+    if (MigrateObject(*candidate.object, *threads_[from], *threads_[to])) {
+      loads[from] -= candidate.load;
+      loads[to] += candidate.load;
+      migrations++;
+    }
+  }
+  for (auto& thread : threads_) {
+    thread->exec_time_.store(loads[thread->index_], std::memory_order_relaxed);
+    // candidates are valid only during the tick they were gathered
+    thread->migration_candidates_.fill({});
+  }
+  if (migrations == 0) {
+    return;
+  }
+  const double after = imbalance();
+  rebalances_.store(rebalances_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+  migrations_.store(migrations_.load(std::memory_order_relaxed) + migrations,
+                    std::memory_order_relaxed);
+  imbalance_before_.store(before, std::memory_order_relaxed);
+  imbalance_after_.store(after, std::memory_order_relaxed);
+}
+
+bool Core::MigrateObject(Ticker& object, UpdateThread& from,
+                         UpdateThread& to) {
+  const PhaseId phase = object.phase();
+  // jobs of a phase which overlaps the next tick may still point to the
+  // schedule
+  if (phases_[phase].finished_tick.load(std::memory_order_relaxed) <
+          global_tick_ ||
+      from.registry_.Get(object.handle()) != &object) {
+    return false;
+  }
+  // the removal is applied by the current owner
+  auto& outgoing = from.phases_[phase].outgoing;
+  if (std::any_of(outgoing.begin(), outgoing.end(),
+                  [&object](std::shared_ptr<Ticker> const& removed) {
+                    return removed.get() == &object;
+                  })) {
+    return false;
+  }
+  if (!from.phases_[phase].objects.Remove(object)) {
+    return false;
+  }
+  to.registry_.Add(from.registry_.Remove(object.handle()));
+  to.phases_[phase].objects.Add(&object, object.tickrate(),
+                                object.tick_offset());
+  object.owner_thread_.store(uint32_t(to.index_), std::memory_order_relaxed);
+  return true;
+}
+
+PhaseId Core::DeclarePhase(std::string name,
+                           std::vector<PhaseId> const& dependencies,
+                           bool overlaps_next_tick) {
+  std::scoped_lock<std::mutex> lock(phases_mutex_);
+  auto id = PhaseId(declared_phase_count_.load(std::memory_order_relaxed));
+  if (id >= phase::kMaxPhases) {
+    return phase::kMaxPhases;
+  }
+  uint32_t mask = 0;
+  for (PhaseId dependency : dependencies) {
+    // phases can depend only on already declared ones, so there are no cycles
+    if (dependency >= id) {
+      return phase::kMaxPhases;
+    }
+    mask |= 1U << dependency;
+  }
+  Phase& phase = phases_[id];
+  phase.name = std::move(name);
+  phase.dependencies = mask;
+  phase.overlaps_next_tick = overlaps_next_tick;
+  phase.pending.store(threads_.size(), std::memory_order_relaxed);
+  declared_phase_count_.store(id + 1, std::memory_order_release);
+  return id;
+}
+
+std::string Core::phase_name(PhaseId id) {
+  std::scoped_lock<std::mutex> lock(phases_mutex_);
+  return id < declared_phase_count_.load(std::memory_order_relaxed)
+             ? phases_[id].name
+             : std::string();
+}
+
+bool Core::PhaseReady(PhaseId id, uint64_t tick) const noexcept {
+  Phase const& phase = phases_[id];
+  // previous instance of the phase should be finished
+  if (phase.finished_tick.load(std::memory_order_acquire) + 1 < tick) {
+    return false;
+  }
+  for (uint32_t mask = phase.dependencies; mask != 0; mask &= mask - 1) {
+    PhaseId dependency = 0;
+    while (((mask >> dependency) & 1U) == 0) {
+      dependency++;
     }
-    lock.lock();
-    double t = time();
-    double wait_t =
-        (1.0e9 / double(tickrate_)) - 1.0e9 * (t - last_tick_timestamp_);
-    if (wait_t > 0) {
-      busy_sleep(std::chrono::nanoseconds((uint32_t)wait_t));
+    if (phases_[dependency].finished_tick.load(std::memory_order_acquire) <
+        tick) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Core::TickFinished(uint64_t tick, bool overlapping) const noexcept {
+  for (size_t id = 0; id < phase_count_; id++) {
+    if ((overlapping || !phases_[id].overlaps_next_tick) &&
+        phases_[id].finished_tick.load(std::memory_order_acquire) < tick) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Core::FinishJobs(PhaseId id, uint64_t tick, size_t count) noexcept {
+  Phase& phase = phases_[id];
+  if (phase.pending.fetch_sub(count, std::memory_order_acq_rel) == count) {
+    // prepare tokens for the next instance before publishing that this one is
+    // finished
+    phase.pending.store(threads_.size(), std::memory_order_relaxed);
+    phase.finished_tick.store(tick, std::memory_order_release);
+  }
+}
+
+std::chrono::nanoseconds Core::calc_overhead() {
+  using namespace std::chrono;
+  // it takes 200ms and doesn't depend on the instance, so every Core created
+  // by a test or a tool after the first one starts right away
+  static const nanoseconds overhead = []() {
+    constexpr size_t tests = 1001;
+    constexpr auto timer = 200us;
+
+    std::condition_variable t;
+    auto init = [&timer, &t]() {
+      auto end = steady_clock::now() + timer;
+      while (steady_clock::now() < end);
+      static_cast<void>(time());
+      t.notify_all();
+    };
+
+    time_point<steady_clock> start;
+    nanoseconds dur[tests];
+
+    for (auto& d : dur) {
+      start = steady_clock::now();
+      init();
+      d = steady_clock::now() - start - timer;
     }
+    std::sort(std::begin(dur), std::end(dur));
+    return dur[tests / 2];
+  }();
+  return overhead;
+}
+
+void Core::ThreadReady() {
+  ENGINE_TRACE_SCOPE("Core::ThreadReady");
+  barrier_.ArriveAndWait([this]() { OnTickEnd(); });
+}
+
+void Core::OnTickEnd() {
+  // the step of the tick which has just finished, a new tickrate is applied
+  // below
+  const uint64_t step = 1000000000ULL / tickrate();
+  const uint64_t tick_start =
+      last_tick_wall_ns_.load(std::memory_order_relaxed);
+  const uint64_t deadline = tick_start + step;
+  const uint64_t now = Clock::now_ns();
+  UpdateOverloadLevel(now - tick_start, step);
+  // RunTicks runs ticks back to back, and there is no point to wait for a
+  // tick which is never run
+  if (deadline > now &&
+      tick_limit_.load(std::memory_order_relaxed) == kFreeRunning &&
+      !stop_requested_.load(std::memory_order_relaxed)) {
+    ENGINE_TRACE_SCOPE("TickPacer::WaitUntil");
+    pacer_.WaitUntil(std::chrono::steady_clock::now() +
+                     std::chrono::nanoseconds(deadline - now));
+  }
+
+  // the threads have gathered the statistics during this tick
+  if (!deterministic_ && threads_.size() > 1 &&
+      global_tick_ % statistics_period() == 0) {
+    ENGINE_TRACE_SCOPE("Core::RebalanceThreads");
+    RebalanceThreads();
+  }
+
+  if (!HoldTick()) {
+    // the threads leave the tick loop, global_tick_ stays the last tick run
+    stopping_ = true;
+    return;
+  }
 
-    t = time();
-    global_tick_ += 1;
-    last_tick_timedelta_ = t - last_tick_timestamp_;
-    last_tick_timestamp_ = t;
+  const uint64_t wall = Clock::now_ns();
+  const uint64_t last_tick =
+      last_tick_timestamp_.load(std::memory_order_relaxed);
+  deterministic_ = deterministic_requested_.load(std::memory_order_relaxed);
+  // in the deterministic mode time is simulated, so it doesn't depend on how
+  // long the tick took
+  const uint64_t t = deterministic_ ? last_tick + step : wall;
+  last_tick_wall_ns_.store(wall, std::memory_order_relaxed);
+  tickrate_.store(tickrate_requested_.load(std::memory_order_relaxed),
+                  std::memory_order_relaxed);
+  global_tick_ += 1;
+  last_tick_timedelta_.store(t - last_tick, std::memory_order_relaxed);
+  last_tick_timestamp_.store(t, std::memory_order_relaxed);
 
-    sync_threads_ = 0;
-    sync_var_.notify_all();
+  // activate phases declared during the previous tick
+  std::scoped_lock<std::mutex> lock(phases_mutex_);
+  const size_t declared =
+      declared_phase_count_.load(std::memory_order_relaxed);
+  for (; phase_count_ < declared; phase_count_++) {
+    phases_[phase_count_].finished_tick.store(global_tick_ - 1,
+                                              std::memory_order_relaxed);
   }
 }
 
-Core::Core() {
-  last_tick_timestamp_ = time();
-  for (size_t i = 0; i < std::thread::hardware_concurrency(); i++) {
-    auto ptr = std::make_unique<UpdateThread>(global_tick_);
+bool Core::HoldTick() {
+  if (stop_requested_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  // the next tick is global_tick_ + 1
+  if (global_tick_ + 1 < tick_limit_.load(std::memory_order_acquire)) {
+    return true;
+  }
+  ENGINE_TRACE_SCOPE("Core::HoldTick");
+  std::unique_lock<std::mutex> lock(control_mutex_);
+  held_ = true;
+  control_.notify_all();
+  control_.wait(lock, [this]() {
+    return stop_requested_.load(std::memory_order_relaxed) ||
+           global_tick_ + 1 < tick_limit_.load(std::memory_order_relaxed);
+  });
+  held_ = false;
+  return !stop_requested_.load(std::memory_order_relaxed);
+}
+
+void Core::Stop() noexcept {
+  {
+    std::scoped_lock<std::mutex> lock(control_mutex_);
+    stop_requested_.store(true, std::memory_order_release);
+  }
+  control_.notify_all();
+}
+
+uint64_t Core::RunTicks(uint64_t n) {
+  std::unique_lock<std::mutex> lock(control_mutex_);
+  // hold first, so the ticks are counted from a known one
+  if (tick_limit_.load(std::memory_order_relaxed) == kFreeRunning) {
+    tick_limit_.store(0, std::memory_order_release);
+  }
+  auto stopped = [this]() {
+    return stop_requested_.load(std::memory_order_relaxed);
+  };
+  control_.wait(lock, [&]() { return held_ || stopped(); });
+  if (!stopped() && n != 0) {
+    tick_limit_.store(global_tick_ + 1 + n, std::memory_order_release);
+    control_.notify_all();
+    control_.wait(lock, [&]() {
+      return stopped() ||
+             (held_ && global_tick_ + 1 >=
+                           tick_limit_.load(std::memory_order_relaxed));
+    });
+  }
+  return tick();
+}
+
+void Core::Resume() {
+  {
+    std::scoped_lock<std::mutex> lock(control_mutex_);
+    tick_limit_.store(kFreeRunning, std::memory_order_release);
+  }
+  control_.notify_all();
+}
+
+Core::Core(CoreConfig config)
+    : config_(std::move(config)),
+      thread_count_(ThreadCount(config_)),
+      tick_limit_(config_.manual_ticks ? 0 : kFreeRunning),
+      tickrate_requested_(config_.tickrate),
+      tickrate_(config_.tickrate) {
+  const uint64_t start = Clock::now_ns();
+  last_tick_wall_ns_.store(start, std::memory_order_relaxed);
+  last_tick_timestamp_.store(start, std::memory_order_relaxed);
+
+  const std::vector<uint32_t> cpus = WorkerCpus();
+  const std::vector<uint32_t> affinity = CpuTopology::current_affinity();
+  for (size_t i = 0; i < thread_count_; i++) {
+    const uint32_t cpu =
+        cpus.empty() ? UpdateThread::kNoCpu : cpus[i % cpus.size()];
+    // Memory is allocated on the node of the CPU which touches it first, so
+    // the thread storage is constructed on the CPU of the thread. The thread
+    // pins itself before it allocates anything else.
+    if (config_.numa_local) {
+      CpuTopology::PinCurrentThread({&cpu, 1});
+    }
+    auto ptr = std::make_unique<UpdateThread>(*this, global_tick_, i, cpu);
     threads_.push_back(std::move(ptr));
   }
-  operational_thread_id_ = threads_[0]->thread_id();
+  // the calling thread was pinned only to place the storage
+  if (config_.numa_local) {
+    CpuTopology::PinCurrentThread(affinity);
+  }
+  // Threads wait until the constructor returns, so built-in phases are
+  // declared before the first tick.
+  DeclarePhase("PreUpdate", {});
+  DeclarePhase("Update", {phase::kPreUpdate});
+  DeclarePhase("PostUpdate", {phase::kUpdate});
+  DeclarePhase("RenderExtract", {phase::kPostUpdate}, true);
+  started_.store(true, std::memory_order_release);
+  started_.notify_all();
+}
+
+Core::~Core() {
+  Stop();
+  // every thread is joined before any of them is destroyed, because the
+  // threads steal jobs from each other until they exit
+  for (auto& thread : threads_) {
+    thread->thread_->join();
+  }
+  // background jobs refer to the threads, suspended tasks are destroyed
+  // with them
+  background_.Stop();
+  threads_.clear();
+}
+
+Core::TickJob* Core::StealJob(size_t thief_index) noexcept {
+  if (deterministic_) {
+    return nullptr;
+  }
+  const size_t size = threads_.size();
+  for (size_t i = 1; i < size; i++) {
+    auto& victim = threads_[(thief_index + i) % size];
+    if (TickJob* job = victim->deque_.Steal(); job != nullptr) {
+      return job;
+    }
+  }
+  return nullptr;
 }
 
-Core::UpdateThread::UpdateThread(uint32_t tick) : local_tick_(tick) {
+Core::UpdateThread::UpdateThread(Core& core, uint64_t tick, size_t index,
+                                 uint32_t cpu)
+    : core_(core), index_(index), cpu_(cpu), local_tick_(tick) {
   this->thread_ =
       std::make_unique<std::thread>(&UpdateThread::ThreadFunction, this);
 }
 Core::UpdateThread::~UpdateThread() {
-  die_ = true;
-  thread_->join();
+  if (thread_->joinable()) {
+    thread_->join();
+  }
+  for (auto& list : phases_) {
+    for (auto const& task : list.sleeping) {
+      DestroyTask(task.handle);
+    }
+  }
+  for (auto const& handle : posted_tasks_) {
+    DestroyTask(handle);
+  }
+}
+double Core::UpdateThread::exec_time() const noexcept {
+  return exec_time_.load(std::memory_order_relaxed);
+}
+
+void Core::UpdateThread::AddObject(std::shared_ptr<Ticker> object) {
+  if (objects_to_add_.TryPush(std::move(object))) {
+    return;
+  }
+  // The queue is drained every tick, it can overflow only during huge bursts.
+  // We can't wait for the owner here, because the owner itself may be adding
+  // objects from Update.
+  std::scoped_lock<std::mutex> lock(overflow_mutex_);
+  overflow_.push_back(std::move(object));
+  has_overflow_.store(true, std::memory_order_release);
+}
+
+void Core::UpdateThread::RemoveObject(std::shared_ptr<Ticker> object) {
+  std::scoped_lock<std::mutex> lock(removal_mutex_);
+  objects_to_remove_.push_back(std::move(object));
+  has_removals_.store(true, std::memory_order_release);
+}
+
+void Core::UpdateThread::MergeAddedObjects() {
+  auto add = [this](std::shared_ptr<Ticker>&& object) {
+    PhaseId phase = object->phase();
+    phases_[phase].incoming.push_back(std::move(object));
+  };
+  objects_to_add_.Drain(add);
+  if (has_overflow_.load(std::memory_order_acquire)) {
+    std::scoped_lock<std::mutex> lock(overflow_mutex_);
+    has_overflow_.store(false, std::memory_order_relaxed);
+    for (auto& object : overflow_) {
+      add(std::move(object));
+    }
+    overflow_.clear();
+  }
+  // removals are merged after additions, so an object which was added and
+  // removed right away is registered first
+  if (has_removals_.load(std::memory_order_acquire)) {
+    std::scoped_lock<std::mutex> lock(removal_mutex_);
+    has_removals_.store(false, std::memory_order_relaxed);
+    for (auto& object : objects_to_remove_) {
+      PhaseId phase = object->phase();
+      phases_[phase].outgoing.push_back(std::move(object));
+    }
+    objects_to_remove_.clear();
+  }
+  if (has_posted_tasks_.load(std::memory_order_acquire)) {
+    std::scoped_lock<std::mutex> lock(task_mutex_);
+    has_posted_tasks_.store(false, std::memory_order_relaxed);
+    const uint64_t tick = core_.global_tick_.load(std::memory_order_relaxed);
+    for (auto const& handle : posted_tasks_) {
+      ScheduleTask(handle, tick);
+    }
+    posted_tasks_.clear();
+  }
+}
+
+void Core::UpdateThread::PostTask(TickTask::Handle handle) {
+  std::scoped_lock<std::mutex> lock(task_mutex_);
+  posted_tasks_.push_back(handle);
+  has_posted_tasks_.store(true, std::memory_order_release);
+}
+
+void Core::UpdateThread::ScheduleTask(TickTask::Handle handle, uint64_t tick) {
+  auto& sleeping = phases_[handle.promise().phase_].sleeping;
+  sleeping.push_back({tick, task_order_++, handle});
+  std::push_heap(sleeping.begin(), sleeping.end(), std::greater<>());
+}
+
+void Core::UpdateThread::ResumeTasks(PhaseObjects& list, uint64_t tick) {
+  auto& sleeping = list.sleeping;
+  while (!sleeping.empty() && sleeping.front().tick <= tick) {
+    std::pop_heap(sleeping.begin(), sleeping.end(), std::greater<>());
+    const TickTask::Handle handle = sleeping.back().handle;
+    sleeping.pop_back();
+    // a finished nested task may be destroyed by its caller during resume
+    const TickTask::Handle root = handle.promise().root_;
+    task_tick_ = tick;
+    handle.resume();
+    if (root.done()) {
+      DestroyTask(root);
+    }
+  }
 }
-double Core::UpdateThread::exec_time() const noexcept { return exec_time_; }
 
-void Core::UpdateThread::AddObject(std::weak_ptr<Ticker> object) {
-  std::scoped_lock<std::mutex> lock(objects_to_add_mutex_);
-  objects_to_add_.push_back(object);
+void Core::UpdateThread::DestroyTask(TickTask::Handle handle) {
+  // nested tasks are owned by the frames of their callers
+  handle.promise().root_.destroy();
+  core_.task_count_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void Core::UpdateThread::ReapUnusedObjects() {
+  registry_.ForEach([this](std::shared_ptr<Ticker> const& object) {
+    if (object.use_count() == 1) {
+      phases_[object->phase()].outgoing.push_back(object);
+    }
+  });
+}
+
+void Core::UpdateThread::UpdateLatencyReport() {
+  // Percentiles take a pass over the histogram, so they are computed only for
+  // the objects with the highest maximum, which is O(1).
+  constexpr size_t kCandidates = kLatencyReportSize * 4;
+  latency_candidates_.clear();
+  registry_.ForEach([this](std::shared_ptr<Ticker> const& object) {
+    latency_candidates_.emplace_back(object->latency().window_max_ns(),
+                                     object.get());
+  });
+  const size_t candidates = std::min(kCandidates, latency_candidates_.size());
+  std::partial_sort(
+      latency_candidates_.begin(), latency_candidates_.begin() + candidates,
+      latency_candidates_.end(),
+      [](auto const& a, auto const& b) { return a.first > b.first; });
+
+  std::vector<TickerLatency> report;
+  report.reserve(candidates);
+  for (size_t i = 0; i < candidates; i++) {
+    Ticker const& object = *latency_candidates_[i].second;
+    report.push_back({object.handle(), index_, object.phase(),
+                      object.tickrate(), object.latency().stats()});
+  }
+  std::sort(report.begin(), report.end(),
+            [](TickerLatency const& a, TickerLatency const& b) {
+              return a.stats.p99_ns > b.stats.p99_ns;
+            });
+  report.resize(std::min(report.size(), kLatencyReportSize));
+
+  std::scoped_lock<std::mutex> lock(latency_report_mutex_);
+  latency_report_ = std::move(report);
 }
 
 std::thread::id Core::UpdateThread::thread_id() const noexcept {
@@ -160,49 +966,300 @@ std::thread::id Core::UpdateThread::thread_id() const noexcept {
 #define malatindez_FORCE_INLINE __attribute__((always_inline))
 #endif
 
-void Core::UpdateThread::ThreadFunction() {
-  std::shared_ptr<Core> core = Core::GetInstance();
-  core->ThreadReady(thread_->get_id());
-  auto update_objects = [this, &core]() malatindez_FORCE_INLINE {
-    for (auto itr = objects_.begin(); itr != objects_.end();) {
-      if (itr->expired()) {  // if object is expired, remove it from objects_
-        itr = objects_.erase(itr);
-      } else {  // update non-expired object
-        itr->lock()->UpdateExecutionTime(core->global_tick_);
-        itr++;
+bool Core::UpdateThread::Skipped(Ticker const& object, size_t index,
+                                  uint64_t tick, uint8_t skip_mask,
+                                  uint8_t half_mask) noexcept {
+  const uint8_t bit = uint8_t(1U << uint8_t(object.priority()));
+  // every second run of the object, alternating between neighbours in the
+  // bucket, so the halved objects don't pile up on the same ticks
+  const bool halved = (half_mask & bit) != 0 &&
+                      (((tick / object.scheduled_tickrate_) + index) & 1) != 0;
+  return (skip_mask & bit) != 0 || halved;
+}
+
+size_t Core::UpdateThread::UpdateObjects(TickSchedule::Bucket& bucket,
+                                         size_t begin, size_t end,
+                                         uint64_t tick, uint8_t skip_mask,
+                                         uint8_t half_mask) {
+  auto& objects = bucket.objects;
+  if ((skip_mask | half_mask) == 0) {
+    for (size_t i = begin; i < end; i++) {
+      objects[i]->UpdateExecutionTime(tick);
+    }
+    return 0;
+  }
+  size_t skipped = 0;
+  for (size_t i = begin; i < end; i++) {
+    if (Skipped(*objects[i], i, tick, skip_mask, half_mask)) {
+      skipped++;
+      continue;
+    }
+    objects[i]->UpdateExecutionTime(tick);
+  }
+  return skipped;
+}
+
+void Core::UpdateThread::ExecuteJob(TickJob const& job) {
+  ENGINE_TRACE_SCOPE("ExecuteJob");
+  if (job.batch != nullptr) {
+    job.bucket->running_cost_ns.fetch_add(
+        job.batch->RunChunk(job.tick, job.begin, job.end),
+        std::memory_order_relaxed);
+    return;
+  }
+  const uint64_t start = Clock::now_ns();
+  const size_t skipped = UpdateObjects(*job.bucket, job.begin, job.end,
+                                       job.tick, job.skip_mask, job.half_mask);
+  if (skipped != 0) {
+    skipped_updates_.fetch_add(skipped, std::memory_order_relaxed);
+  }
+  // the schedule balances tick offsets by the measured cost of the buckets
+  job.bucket->running_cost_ns.fetch_add(Clock::now_ns() - start,
+                                        std::memory_order_relaxed);
+}
+
+void Core::UpdateThread::StartPhase(Core& core, PhaseId phase, uint64_t tick) {
+  ENGINE_TRACE_SCOPE("StartPhase");
+  // Maximum amount of objects in one job
+  constexpr size_t kMaxJobSize = 64;
+  // Amount of jobs each thread should have to balance load between threads
+  constexpr size_t kJobsPerThread = 4;
+
+  // The previous instance of the phase is finished, so nobody else is
+  // reading these lists right now
+  PhaseObjects& list = phases_[phase];
+  list.objects.SetAdaptive(!core.deterministic_);
+  list.bound_objects.SetAdaptive(!core.deterministic_);
+  list.batches.SetAdaptive(!core.deterministic_);
+  for (auto& object : list.incoming) {
+    if (object->handle().valid()) {  // added twice
+      continue;
+    }
+    Ticker* raw = object.get();
+    registry_.Add(std::move(object));
+    if (!raw->thread_id().expired()) {
+      list.bound_objects.Add(raw, raw->tickrate(), raw->tick_offset());
+    } else if (raw->batched_) {
+      list.batches.Add(raw, raw->tickrate(), raw->tick_offset());
+    } else {
+      list.objects.Add(raw, raw->tickrate(), raw->tick_offset());
+    }
+  }
+  list.incoming.clear();
+  for (auto& object : list.outgoing) {
+    // the handle is stale if the object was already removed, or if it has
+    // migrated to another thread after the removal was requested
+    if (registry_.Get(object->handle()) != object.get()) {
+      const uint32_t owner =
+          object->owner_thread_.load(std::memory_order_relaxed);
+      if (owner != index_ && owner < core.threads_.size()) {
+        core.threads_[owner]->RemoveObject(std::move(object));
       }
+      continue;
     }
-  };
+    if (!list.objects.Remove(*object) && !list.batches.Remove(*object)) {
+      list.bound_objects.Remove(*object);
+    }
+    registry_.Remove(object->handle());
+  }
+  // objects which aren't held by anybody else are destroyed here
+  list.outgoing.clear();
 
-  // 16 times per second
-  auto add_objects_tickrate = (uint32_t)ceil((double)core->tickrate_ / 16);
-  // 4 times per second
-  auto update_exec_time_tickrate = (uint32_t)ceil((double)core->tickrate_ / 4);
+  due_buckets_.clear();
+  size_t due = 0;
+  list.objects.ForEachDue(tick, [this, &due](TickSchedule::Bucket& bucket) {
+    due_buckets_.push_back(&bucket);
+    due += bucket.objects.size();
+  });
+
+  // see OverloadStats
+  constexpr uint8_t kLow = 1U << uint8_t(TickPriority::kLow);
+  constexpr uint8_t kNormal = 1U << uint8_t(TickPriority::kNormal);
+  const uint32_t level = core.overload_level_.load(std::memory_order_relaxed);
+  const uint8_t skip_mask = level >= 2 ? kLow : 0;
+  const uint8_t half_mask = level == 1 ? kLow : level >= 3 ? kNormal : 0;
 
-  auto exec_time_accumulate_ =
-      [](double a, std::weak_ptr<Ticker> object) malatindez_FORCE_INLINE {
-        return a +
-               object.lock()->average_update_time() / object.lock()->tickrate();
-      };
+  // Jobs should be created before pushing them onto the deque, so pointers to
+  // them stay valid while other threads are executing them
+  const size_t job_size = std::clamp<size_t>(
+      due / (core.threads_.size() * kJobsPerThread), 1, kMaxJobSize);
+  list.jobs.clear();
+  for (TickSchedule::Bucket* bucket : due_buckets_) {
+    const size_t size = bucket->objects.size();
+    for (size_t begin = 0; begin < size; begin += job_size) {
+      list.jobs.push_back({bucket, tick, begin,
+                           std::min(begin + job_size, size), phase,
+                           skip_mask, half_mask});
+    }
+  }
+  // batches are split into chunks for all threads regardless of the amount
+  // of the other due objects
+  const size_t workers = core.threads_.size() * kJobsPerThread;
+  size_t skipped = 0;
+  list.batches.ForEachDue(tick, [&](TickSchedule::Bucket& bucket) {
+    for (size_t i = 0; i < bucket.objects.size(); i++) {
+      auto* batch = static_cast<BatchTickerBase*>(bucket.objects[i]);
+      if (!batch->needs_update()) {
+        continue;
+      }
+      if (Skipped(*batch, i, tick, skip_mask, half_mask)) {
+        skipped++;
+        continue;
+      }
+      const size_t chunk = batch->BeginChunks(tick, workers);
+      const size_t size = batch->batch_size();
+      for (size_t begin = 0; begin < size; begin += chunk) {
+        list.jobs.push_back({&bucket, tick, begin,
+                             std::min(begin + chunk, size), phase, 0, 0,
+                             batch});
+      }
+    }
+  });
+
+  core.phases_[phase].pending.fetch_add(list.jobs.size(),
+                                        std::memory_order_relaxed);
+  for (auto& job : list.jobs) {
+    if (!deque_.Push(&job)) {  // deque is full, execute the job right now
+      ExecuteJob(job);
+      core.FinishJobs(phase, tick, 1);
+    }
+  }
+
+  list.bound_objects.ForEachDue(tick, [&](TickSchedule::Bucket& bucket) {
+    const uint64_t start = Clock::now_ns();
+    skipped += UpdateObjects(bucket, 0, bucket.objects.size(), tick,
+                             skip_mask, half_mask);
+    bucket.running_cost_ns.fetch_add(Clock::now_ns() - start,
+                                     std::memory_order_relaxed);
+  });
+  if (skipped != 0) {
+    skipped_updates_.fetch_add(skipped, std::memory_order_relaxed);
+  }
+  if (!list.sleeping.empty()) {
+    ENGINE_TRACE_SCOPE("ResumeTasks");
+    ResumeTasks(list, tick);
+  }
+  // release the token which was holding the counter
+  core.FinishJobs(phase, tick, 1);
+}
+
+void Core::UpdateThread::RunTick(Core& core) {
+  const uint64_t tick = core.global_tick_;
+  const size_t phase_count = core.phase_count_;
+  const uint32_t all_phases =
+      phase_count >= 32 ? ~0U : (1U << phase_count) - 1U;
+
+  uint32_t started = 0;
+  while (true) {
+    for (PhaseId id = 0; id < phase_count; id++) {
+      if ((started & (1U << id)) == 0 && core.PhaseReady(id, tick)) {
+        started |= 1U << id;
+        StartPhase(core, id, tick);
+      }
+    }
 
-  while (!die_) {
-    update_objects();
+    if (RunJob(core)) {
+      continue;
+    }
+    if (started == all_phases && core.TickFinished(tick)) {
+      break;
+    }
+    std::this_thread::yield();
+  }
+}
 
-    // add objects 16 times per second
-    if ((local_tick_ % add_objects_tickrate) == 0 && !objects_to_add_.empty()) {
-      std::scoped_lock<std::mutex> lock(objects_to_add_mutex_);
-      objects_.insert(objects_.end(), objects_to_add_.begin(),
-                      objects_to_add_.end());
-      objects_to_add_.clear();
+bool Core::UpdateThread::RunJob(Core& core) {
+  TickJob* job = deque_.Pop();
+  if (job == nullptr) {
+    job = core.StealJob(index_);
+  }
+  if (job == nullptr) {
+    return false;
+  }
+  ExecuteJob(*job);
+  core.FinishJobs(job->phase, job->tick, 1);
+  return true;
+}
+
+void Core::UpdateThread::ThreadFunction() {
+  if (cpu_ != kNoCpu) {
+    CpuTopology::PinCurrentThread({&cpu_, 1});
+  }
+  Core& core = core_;
+  core.started_.wait(false, std::memory_order_acquire);
+  current_ = &core;
+  ENGINE_TRACE_THREAD_NAME("UpdateThread " + std::to_string(index_));
+  core.ThreadReady();
+
+  // recent mean reacts to the changes of the load, unlike the lifetime one
+  auto object_load = [](Ticker const& object) malatindez_FORCE_INLINE {
+    return object.latency().mean_ns() / 1e9 / std::max(object.tickrate(), 1U);
+  };
+
+  while (!core.stopping_) {
+    const uint64_t busy_start = Clock::now_ns();
+    // objects are merged into the phase lists when the phase starts
+    {
+      ENGINE_TRACE_SCOPE("MergeAddedObjects");
+      MergeAddedObjects();
     }
+    {
+      ENGINE_TRACE_SCOPE("RunTick");
+      RunTick(core);
+    }
+
+    // the period follows the tickrate, which changes only between ticks, so
+    // the threads and RebalanceThreads agree on it
+    if ((local_tick_ % core.statistics_period()) == 0) {
+      ENGINE_TRACE_SCOPE("UpdateStatistics");
+      double exec_time = 0;
+      const double tickrate = core.tickrate();
+      migration_candidates_.fill({});
+      std::array<uint32_t, 64> class_counts{};
+      registry_.ForEach([this, &exec_time, &object_load, &class_counts,
+                         tickrate](std::shared_ptr<Ticker> const& object) {
+        // chunks of batches are spread over all threads, so they don't add
+        // to the load of the owner and aren't worth migrating
+        if (object->batched_ && object->thread_id_ == nullptr) {
+          return;
+        }
+        const double load = object_load(*object) * tickrate;
+        exec_time += load;
+        if (object->thread_id_ == nullptr) {
+          const size_t load_class =
+              std::min<size_t>(std::bit_width(uint64_t(load * 1e9)), 63);
+          const size_t slot =
+              class_counts[load_class]++ % kCandidatesPerClass;
+          migration_candidates_[load_class * kCandidatesPerClass + slot] = {
+              object.get(), load};
+        }
+      });
+      exec_time_.store(exec_time, std::memory_order_relaxed);
+      object_count_.store(registry_.size(), std::memory_order_relaxed);
+      UpdateLatencyReport();
+      ReapUnusedObjects();
+    }
+    const uint64_t barrier_start = Clock::now_ns();
+    core.ThreadReady();
+    const uint64_t barrier_end = Clock::now_ns();
+    busy_ns_.store(busy_ns_.load(std::memory_order_relaxed) + barrier_start -
+                       busy_start,
+                   std::memory_order_relaxed);
+    barrier_ns_.store(barrier_ns_.load(std::memory_order_relaxed) +
+                          barrier_end - barrier_start,
+                      std::memory_order_relaxed);
+    finished_ticks_.store(finished_ticks_.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+    local_tick_ = core.global_tick_;
+  }
 
-    if ((local_tick_ % update_exec_time_tickrate) == 0) {
-      exec_time_ = std::accumulate(std::begin(objects_), std::end(objects_),
-                                   0.0, exec_time_accumulate_);
-      exec_time_ *= core->tickrate_;
+  // phases of the last tick which overlap the next one are finished here,
+  // so every object is updated the same amount of times in every phase
+  while (!core.TickFinished(core.global_tick_, true)) {
+    if (!RunJob(core)) {
+      std::this_thread::yield();
     }
-    core->ThreadReady(thread_->get_id());
-    local_tick_ = core->global_tick_;
   }
+  current_ = nullptr;
 }
 }  // namespace engine::core
\ No newline at end of file
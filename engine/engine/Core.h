@@ -1,10 +1,13 @@
 #pragma once
-#include <GLFW/glfw3.h>
-
 #include <map>
+#include <array>
 #include <mutex>
+#include <string>
+#include <atomic>
+#include <thread>
 #include <chrono>
 #include <memory>
+#include <span>
 #include <vector>
 #include <numeric>
 #include <iostream>
@@ -13,16 +16,31 @@
 #include <condition_variable>
 
 
+#include "BatchTicker.h"
+#include "TickTask.h"
 #include "Ticker.h"
-#include "engine/client/render/Shader.h"
+#include "engine/core/BackgroundWorkers.h"
+#include "engine/core/Clock.h"
+#include "engine/core/CoreConfig.h"
+#include "engine/core/LatencyHistogram.h"
+#include "engine/core/MpscQueue.h"
+#include "engine/core/TickBarrier.h"
+#include "engine/core/TickPacer.h"
+#include "engine/core/TickPhase.h"
+#include "engine/core/TickSchedule.h"
+#include "engine/core/TickerRegistry.h"
+#include "engine/core/Trace.h"
+#include "engine/core/WorkStealingDeque.h"
 
 namespace engine::core {
 
-// Singleton class instance of which you can get by calling the GetInstance
-// function.
-// GetInstance SHOULD be called before calling any static function inside Core.
-// Otherwise std::terminate will be called because core_ptr_ is equal to
-// nullptr.
+// The engine instance is a singleton which you can get by calling the
+// GetInstance function. Tests and tools can create more instances with
+// Create.
+// Static functions refer to the Core of the calling update thread, and to the
+// GetInstance one on other threads. GetInstance SHOULD be called before
+// calling them from other threads, otherwise std::terminate will be called
+// because there is no Core.
 class Core final {
  public:
   /* Disable copy and move semantics. */
@@ -30,88 +48,625 @@ class Core final {
   Core(Core&&) = delete;
   Core& operator=(const Core&) = delete;
   Core& operator=(Core&&) = delete;
-  ~Core() {
-    for (auto& thread : threads_) {
-      thread.reset();
-    }
-  }
+  // Stops the Core, see Stop, and releases the objects. Shouldn't be called
+  // from the update threads of this Core.
+  ~Core();
 
+  // Seconds since the engine start. Monotonic, see Clock.
   [[nodiscard]] static double time();
 
+  // Timestamp of the beginning of the current tick in nanoseconds, see Clock.
+  // It is cached once per tick, so it is cheaper than reading the clock.
+  [[nodiscard]] static uint64_t tick_time_ns() noexcept;
+
   [[nodiscard]] static uint64_t global_tick() noexcept;
 
   // returns shared pointer to the Core.
   [[nodiscard]] static std::shared_ptr<Core> GetInstance() noexcept;
 
+  /// <summary>
+  /// Creates a Core which isn't the GetInstance one, e.g. for tests and
+  /// tools. The config is used as is, the config file and the environment
+  /// aren't read. The Core is destroyed with the last pointer to it.
+  /// Returns nullptr if the config isn't CoreConfig::Valid().
+  /// </summary>
+  [[nodiscard]] static std::shared_ptr<Core> Create(CoreConfig config);
+
+  /// <summary>
+  /// Releases the GetInstance Core, it is stopped and destroyed once nobody
+  /// else holds it. The next GetInstance creates a new one. Static functions
+  /// shouldn't be called from other threads meanwhile.
+  /// </summary>
+  static void Shutdown();
+
+  /// <summary>
+  /// Stops the update threads after the current tick. Every thread finishes
+  /// the same tick, phases which overlap the next tick are finished as well,
+  /// then the threads exit. Ticks which aren't started yet are never run.
+  /// Returns without waiting, the destructor joins the threads.
+  /// </summary>
+  void Stop() noexcept;
+
+  // Amount of ticks since the start, unlike the static global_tick() it can
+  // be called from any thread for any Core.
+  [[nodiscard]] uint64_t tick() const noexcept {
+    return global_tick_.load(std::memory_order_relaxed);
+  }
+
+  /// <summary>
+  /// Runs n ticks as fast as possible, without pacing and the overload
+  /// policy, and holds before the next one. Returns when they are finished,
+  /// or when the Core is stopped. Time still follows the wall clock unless
+  /// the Core is deterministic, see SetDeterministic.
+  /// A Core with CoreConfig::manual_ticks starts held.
+  /// </summary>
+  /// <returns>the tick the Core is holding at</returns>
+  uint64_t RunTicks(uint64_t n);
+
+  // Lets a held Core tick on its own again, paced by the tickrate.
+  void Resume();
+
+  /// <summary>
+  /// Sets the worker pool settings, see CoreConfig. The config file and the
+  /// environment variables override them when the Core is created.
+  /// Only the update threads are pinned, the thread which creates the Core
+  /// keeps its affinity, so the main/render thread can pin itself to the
+  /// reserved CPUs with CpuTopology::PinCurrentThread.
+  /// </summary>
+  /// <returns>false if the Core is already created or the config isn't
+  /// CoreConfig::Valid()</returns>
+  static bool Configure(CoreConfig config);
+
+  // Settings the Core was created with.
+  [[nodiscard]] CoreConfig const& config() const noexcept { return config_; }
+
   /// <summary>
   /// Calculates tickrate based on how many times you want your function being
-  /// called.
+  /// called. The result depends on the current Core tickrate, objects aren't
+  /// rescheduled when it changes. Systems which should run at a fixed rate
+  /// regardless of it can use FixedStep.
   /// </summary>
   /// <param name="times_per_second">how many times you want your function being
   /// called</param> <returns>Tickrate</returns>
   [[nodiscard]] static uint32_t CalcTickrate(uint32_t times_per_second);
 
+  // Ticks per second the Core is paced to.
+  [[nodiscard]] uint32_t tickrate() const noexcept {
+    return tickrate_.load(std::memory_order_relaxed);
+  }
+
+  /// <summary>
+  /// Changes the amount of ticks per second, takes effect from the next tick.
+  /// The tick budget of the overload policy and the statistics period follow
+  /// it. Tickers keep updating every tickrate() ticks, so their frequency
+  /// changes with the Core tickrate.
+  /// </summary>
+  /// <returns>false if the tickrate is zero or above
+  /// CoreConfig::kMaxTickrate</returns>
+  bool SetTickrate(uint32_t tickrate) noexcept;
+
+  /// <summary>
+  /// Part of the current tick which has passed on the wall clock, from 0 to
+  /// 1. The renderer draws objects at
+  /// lerp(state of the previous tick, state of the current tick, alpha), so
+  /// the motion is smooth at any frame rate without raising the tickrate.
+  /// </summary>
+  [[nodiscard]] static double interpolation_alpha() noexcept;
+
+  // Duration of the previous tick in seconds
   [[nodiscard]] static double tick_delta();
+  // Duration of the previous tick in nanoseconds
+  [[nodiscard]] static uint64_t tick_delta_ns() noexcept;
 
   // returns 1 if succeed
   // 0 if failed
-  int AddTickingObject(std::weak_ptr<Ticker> object);
+  // Objects are activated at the beginning of the next tick. The Core keeps
+  // the object alive until it is removed, or until nobody else holds it,
+  // which is checked a few times per second. Each object should be added
+  // only once.
+  int AddTickingObject(std::shared_ptr<Ticker> object);
+
+  // Adds a batch of objects, e.g. during the level load.
+  // Objects which are not bound to a thread are spread evenly between
+  // threads. Returns the amount of objects that were added.
+  size_t AddTickingObjects(std::span<const std::shared_ptr<Ticker>> objects);
+
+  // Objects are removed at the beginning of their phase in the next tick.
+  // The Core releases its reference there, so if nobody else holds the object
+  // it is destroyed by the update thread. Shouldn't be called concurrently
+  // with AddTickingObject for the same object.
+  void RemoveTickingObject(std::shared_ptr<Ticker> const& object);
+
+  /// <summary>
+  /// Starts the task at the beginning of the phase in the next tick, see
+  /// TickTask. Tasks are spread over the update threads, each one always
+  /// runs on the same thread. Can be called from any thread.
+  /// </summary>
+  /// <returns>false if the task is empty or the phase isn't
+  /// declared</returns>
+  bool Spawn(TickTask task, PhaseId phase = phase::kUpdate);
+
+  // Amount of spawned tasks which haven't finished yet.
+  [[nodiscard]] size_t task_count() const noexcept {
+    return task_count_.load(std::memory_order_relaxed);
+  }
+
+  // Controls how the engine waits for the next tick and exports the jitter
+  // statistics of the waits. TickPacer::Mode::kUnpaced runs ticks back to
+  // back, e.g. to replay a capture at maximum speed.
+  [[nodiscard]] TickPacer& pacer() noexcept { return pacer_; }
+
+  /// <summary>
+  /// Lockstep mode which gives the same results for the same inputs.
+  /// Tick time advances by exactly 1 / tickrate seconds per tick, objects
+  /// which aren't bound to a thread are updated by the first thread in a
+  /// stable order, jobs aren't stolen and tick offsets don't depend on the
+  /// measured update time.
+  /// Takes effect from the next tick. It can be enabled only before the
+  /// first object or task is added, the ones which were already spread
+  /// between the threads would keep their threads. Objects added from
+  /// threads other than the update threads are activated on whatever tick
+  /// the Core is at, so for reproducible runs they should be added from
+  /// Update.
+  /// </summary>
+  /// <returns>false if it is enabled after objects or tasks were added, the
+  /// mode isn't changed then</returns>
+  bool SetDeterministic(bool deterministic) noexcept;
+  [[nodiscard]] bool deterministic() const noexcept;
+
+  /// <summary>
+  /// Declares a new tick phase. Objects are attached to the phase through
+  /// Ticker::SetPhase. The phase is executed starting from the next tick.
+  /// </summary>
+  /// <param name="name">name of the phase</param>
+  /// <param name="dependencies">phases which should be finished in the
+  /// current tick before this phase starts</param>
+  /// <param name="overlaps_next_tick">if true, the tick doesn't wait for this
+  /// phase, it is finished during the next tick instead</param>
+  /// <returns>id of the phase, or phase::kMaxPhases if there are too many
+  /// phases or one of the dependencies isn't declared</returns>
+  PhaseId DeclarePhase(std::string name,
+                       std::vector<PhaseId> const& dependencies,
+                       bool overlaps_next_tick = false);
+
+  [[nodiscard]] std::string phase_name(PhaseId id);
+
+  struct TickerLatency {
+    TickerHandle handle;
+    // index of the update thread which owns the ticker
+    size_t thread;
+    PhaseId phase;
+    uint32_t tickrate;
+    LatencyStats stats;
+  };
+
+  static constexpr size_t kLatencyReportSize = 16;
+
+  // Tickers with the highest p99 Update time over the last one to two
+  // seconds. Each update thread refreshes its kLatencyReportSize slowest
+  // tickers 4 times per second, so the result may be up to 250ms old.
+  [[nodiscard]] std::vector<TickerLatency> SlowestTickers(
+      size_t count = kLatencyReportSize);
+
+  // Writes {"threads":[{"exec_time":..,"objects":..},..],"slowest":[..]}
+  void WriteLatencyJson(std::ostream& out,
+                        size_t count = kLatencyReportSize);
+
+  // Ids of the update threads. Objects can be bound to one of them through
+  // the Ticker constructor.
+  [[nodiscard]] std::vector<std::thread::id> thread_ids() const;
+
+  // Counters of an update thread since the engine start, the difference of
+  // two samples gives the utilisation over a period.
+  struct ThreadStats {
+    // ticks the thread has finished
+    uint64_t ticks = 0;
+    // time spent on merging, updating and stealing jobs
+    uint64_t busy_ns = 0;
+    // time spent in ThreadReady, including the wait for the next tick
+    uint64_t barrier_ns = 0;
+  };
+  [[nodiscard]] std::vector<ThreadStats> thread_stats() const;
+
+  // Imbalance is max / mean - 1 of the update time the threads own.
+  struct MigrationStats {
+    // checks which have moved at least one object
+    uint64_t rebalances = 0;
+    uint64_t migrations = 0;
+    // of the last rebalance
+    double imbalance_before = 0;
+    double imbalance_after = 0;
+  };
+  [[nodiscard]] MigrationStats migration_stats() const noexcept;
+  // Ticks between the updates of the thread statistics and the rebalancing
+  // checks, a quarter of a second.
+  [[nodiscard]] uint32_t statistics_period() const noexcept;
+
+  /// <summary>
+  /// Overload policy. When the work of a tick takes longer than 1 / tickrate,
+  /// the overload level is raised by one for the next tick:
+  ///   1  TickPriority::kLow objects are updated at half their rate
+  ///   2  kLow objects are skipped
+  ///   3  kNormal objects are updated at half their rate as well
+  /// kCritical objects are always updated. The level drops by one after
+  /// kRecoveryTicks ticks in a row which took less than kRecoveryLoad of the
+  /// budget. Halved objects are spread over even and odd ticks, so the load
+  /// is halved too. The policy is off by default, since it changes how often
+  /// kNormal objects are updated, and it doesn't apply in the deterministic
+  /// and the unpaced mode and in RunTicks, where the tick has no budget.
+  /// </summary>
+  void SetOverloadControl(bool enabled) noexcept;
+  [[nodiscard]] bool overload_control() const noexcept;
+
+  static constexpr uint32_t kMaxOverloadLevel = 3;
+  static constexpr uint32_t kRecoveryTicks = 32;
+  static constexpr double kRecoveryLoad = 0.75;
+
+  // Counters since the engine start.
+  struct OverloadStats {
+    // ticks whose work took longer than the budget
+    uint64_t overrun_ticks = 0;
+    // ticks executed with a non-zero overload level
+    uint64_t degraded_ticks = 0;
+    // updates which were skipped by the policy
+    uint64_t skipped_updates = 0;
+    // current overload level
+    uint32_t level = 0;
+    // the longest overrun beyond the budget
+    uint64_t max_overrun_ns = 0;
+  };
+  [[nodiscard]] OverloadStats overload_stats() const;
 
 
  private:
+  class UpdateThread;
+  friend struct TickTask::promise_type;
+
+  struct MigrationCandidate {
+    Ticker* object = nullptr;
+    // update time per second
+    double load = 0;
+  };
+
+  // Contiguous range of objects from one of the owner's due buckets, or a
+  // chunk of instances of a batch from the bucket.
+  // Jobs are created by the owner when the phase starts and are executed
+  // either by the owner or by any other thread that stole them.
+  struct TickJob {
+    TickSchedule::Bucket* bucket;
+    uint64_t tick;
+    size_t begin;
+    size_t end;
+    PhaseId phase;
+    // bits of TickPriority which are skipped or updated at half rate
+    uint8_t skip_mask;
+    uint8_t half_mask;
+    // if set, begin and end are indices of the batch instances
+    BatchTickerBase* batch = nullptr;
+  };
+
+  struct Phase {
+    std::string name;
+    // bitmask of phases which should be finished before this one
+    uint32_t dependencies = 0;
+    bool overlaps_next_tick = false;
+    // Seed tokens of every thread plus the amount of unfinished jobs.
+    // Each thread holds its token until it pushes all of its jobs, so the
+    // counter can't reach zero before every thread has published its work.
+    alignas(64) std::atomic<size_t> pending = 0;
+    // The last tick in which this phase was finished
+    std::atomic<uint64_t> finished_tick = 0;
+  };
+
   class UpdateThread {
    public:
-    explicit UpdateThread(uint32_t tick);
+    static constexpr uint32_t kNoCpu = UINT32_MAX;
+
+    // cpu is the CPU the thread pins itself to, or kNoCpu.
+    UpdateThread(Core& core, uint64_t tick, size_t index, uint32_t cpu);
     ~UpdateThread();
     [[nodiscard]] double exec_time() const noexcept;
 
-    void AddObject(std::weak_ptr<Ticker> object);
+    // Can be called from any thread, doesn't block unless the registration
+    // queue overflows.
+    void AddObject(std::shared_ptr<Ticker> object);
+    // Can be called from any thread.
+    void RemoveObject(std::shared_ptr<Ticker> object);
 
     [[nodiscard]] std::thread::id thread_id() const noexcept;
     
     
    private:
-    [[noreturn]] void ThreadFunction();
-    bool die_ = false;
+    friend class Core;
+
+    struct SleepingTask {
+      uint64_t tick;
+      // tasks due on the same tick are resumed in the order of suspension
+      uint64_t order;
+      TickTask::Handle handle;
+
+      // std::greater makes a min-heap
+      bool operator>(SleepingTask const& other) const noexcept {
+        return tick != other.tick ? tick > other.tick : order > other.order;
+      }
+    };
+
+    struct PhaseObjects {
+      // objects that can be updated by any thread
+      TickSchedule objects;
+      // objects that should be updated only by this thread
+      TickSchedule bound_objects;
+      // batches that can be updated by any thread, they are split into
+      // chunks, see BatchTickerBase. Bound batches are in bound_objects.
+      TickSchedule batches;
+      // objects that will be merged when the phase starts next time
+      std::vector<std::shared_ptr<Ticker>> incoming;
+      // objects that will be removed when the phase starts next time
+      std::vector<std::shared_ptr<Ticker>> outgoing;
+      std::vector<TickJob> jobs;
+      // suspended tasks, a min-heap by the tick they are resumed in
+      std::vector<SleepingTask> sleeping;
+    };
+
+    // Starts phases as soon as their dependencies are finished, executes own
+    // jobs and steals jobs from other threads until every phase that doesn't
+    // overlap the next tick is finished.
+    void RunTick(Core& core);
+
+    // Executes one of the own jobs or steals one. Returns false if there was
+    // nothing to execute.
+    bool RunJob(Core& core);
+
+    // Splits objects of the phase that are due on this tick into jobs and
+    // pushes them onto the deque_, then updates objects that are bound to this
+    // thread.
+    void StartPhase(Core& core, PhaseId phase, uint64_t tick);
+
+    void ExecuteJob(TickJob const& job);
+
+    // Returns true if the overload policy skips this update of the object,
+    // index is its position in the bucket.
+    static bool Skipped(Ticker const& object, size_t index, uint64_t tick,
+                        uint8_t skip_mask, uint8_t half_mask) noexcept;
+    // Updates objects [begin, end) of the bucket except those the overload
+    // policy skips. Returns the amount of skipped objects.
+    static size_t UpdateObjects(TickSchedule::Bucket& bucket, size_t begin,
+                                size_t end, uint64_t tick, uint8_t skip_mask,
+                                uint8_t half_mask);
 
-    std::mutex objects_to_add_mutex_;
-    std::vector<std::weak_ptr<Ticker>> objects_to_add_;
-    std::vector<std::weak_ptr<Ticker>> objects_;
+    // Moves objects from the registration queue and the removal list into
+    // the phase lists, and posted tasks into the sleeping ones.
+    void MergeAddedObjects();
+
+    // Can be called from any thread, the task is resumed in its phase of the
+    // next tick the thread starts.
+    void PostTask(TickTask::Handle handle);
+    // Called only by this thread.
+    void ScheduleTask(TickTask::Handle handle, uint64_t tick);
+    // Resumes the sleeping tasks of the phase which are due.
+    void ResumeTasks(PhaseObjects& list, uint64_t tick);
+    // Destroys the spawned task the handle belongs to.
+    void DestroyTask(TickTask::Handle handle);
+
+    // Removes objects which are held only by the registry.
+    void ReapUnusedObjects();
+
+    // Finds the slowest objects of this thread for SlowestTickers.
+    void UpdateLatencyReport();
+
+    // Runs ticks until the Core stops, then finishes the phases which
+    // overlap the next tick.
+    void ThreadFunction();
+
+    static constexpr size_t kRegistrationQueueCapacity = 8192;
+
+    MpscQueue<std::shared_ptr<Ticker>, kRegistrationQueueCapacity>
+        objects_to_add_;
+    // used only if the registration queue is full
+    std::mutex overflow_mutex_;
+    std::vector<std::shared_ptr<Ticker>> overflow_;
+    std::atomic<bool> has_overflow_ = false;
+    // removal is rare, so it is just a list under the mutex
+    std::mutex removal_mutex_;
+    std::vector<std::shared_ptr<Ticker>> objects_to_remove_;
+    std::atomic<bool> has_removals_ = false;
+    // spawned tasks and tasks whose background job is finished
+    std::mutex task_mutex_;
+    std::vector<TickTask::Handle> posted_tasks_;
+    std::atomic<bool> has_posted_tasks_ = false;
+    // see SleepingTask, used only by this thread
+    uint64_t task_order_ = 0;
+    // tick of the tasks which are being resumed
+    uint64_t task_tick_ = 0;
+    // owns the objects of this thread, touched only by this thread
+    TickerRegistry registry_;
+    std::vector<std::pair<uint64_t, Ticker*>> latency_candidates_;
+    std::mutex latency_report_mutex_;
+    std::vector<TickerLatency> latency_report_;
+    std::atomic<size_t> object_count_ = 0;
+    // see ThreadStats, written only by this thread
+    std::atomic<uint64_t> finished_ticks_ = 0;
+    std::atomic<uint64_t> busy_ns_ = 0;
+    std::atomic<uint64_t> barrier_ns_ = 0;
+    // updates skipped by the overload policy in the jobs this thread executed
+    std::atomic<uint64_t> skipped_updates_ = 0;
+    std::array<PhaseObjects, phase::kMaxPhases> phases_;
+    // due buckets of the phase that is being started
+    std::vector<TickSchedule::Bucket*> due_buckets_;
+    WorkStealingDeque<TickJob> deque_;
     std::unique_ptr<std::thread> thread_;
-    double exec_time_ = 0;
+    // update time of the owned objects per second, written by this thread
+    // and by RebalanceThreads
+    std::atomic<double> exec_time_ = 0;
+    // A few objects per power of two of the update time, gathered with
+    // exec_time_, so RebalanceThreads can choose one which fits the gap
+    // between threads without going over all objects.
+    static constexpr size_t kCandidatesPerClass = 4;
+    std::array<MigrationCandidate, 64 * kCandidatesPerClass>
+        migration_candidates_;
+
+    Core& core_;
+    // index of this thread in Core::threads_
+    const size_t index_;
+    const uint32_t cpu_;
 
     // stores current local tick
     uint64_t local_tick_ = 0;
   };
 
+  // Returns the thread the object is bound to, or the thread with the minimum
+  // execution time. Returns nullptr if the bound thread doesn't exist.
+  [[nodiscard]] UpdateThread* ChooseThread(Ticker const& object) const;
+
+  // Rebalancing starts when the imbalance stays above the start threshold
+  // for kImbalancedChecks checks in a row and continues until it drops below
+  // the stop threshold, so the noise of the measurements doesn't move
+  // objects back and forth.
+  static constexpr double kMigrationStartImbalance = 0.2;
+  static constexpr double kMigrationStopImbalance = 0.1;
+  static constexpr uint32_t kImbalancedChecks = 2;
+  static constexpr size_t kMaxMigrationsPerRebalance = 16;
+
+  // Moves unbound objects from the most loaded threads to the least loaded
+  // ones. Called between ticks, while every update thread is waiting.
+  void RebalanceThreads();
+  // Returns false if the object can't be moved right now.
+  bool MigrateObject(Ticker& object, UpdateThread& from, UpdateThread& to);
+
+  // Raises or lowers the overload level by the work time of the tick which
+  // has just finished. Called between ticks.
+  void UpdateOverloadLevel(uint64_t work_ns, uint64_t budget_ns);
+
+  // Resumes the task in its phase of tick + ticks, called by the thread of
+  // the task.
+  void SuspendTask(TickTask::Handle handle, uint64_t ticks);
+  // Resumes the task in its phase of the next tick after the job is
+  // executed by background_.
+  void SuspendTask(TickTask::Handle handle, std::function<void()> job);
+
+  // Blocks the completion of the barrier while the Core is held by
+  // RunTicks. Returns false if the Core should stop.
+  bool HoldTick();
+
+  // Tries to steal a job from any thread except the thief.
+  TickJob* StealJob(size_t thief_index) noexcept;
+
+  // Returns true if the phase can be started in the given tick.
+  [[nodiscard]] bool PhaseReady(PhaseId id, uint64_t tick) const noexcept;
+  // Returns true if every phase that doesn't overlap the next tick is
+  // finished, or every phase if overlapping is true.
+  [[nodiscard]] bool TickFinished(uint64_t tick,
+                                  bool overlapping = false) const noexcept;
+  // Marks jobs (or seed tokens) of the phase as finished.
+  void FinishJobs(PhaseId id, uint64_t tick, size_t count) noexcept;
+
   static std::chrono::nanoseconds calc_overhead();
 
   const std::chrono::nanoseconds overhead_ = calc_overhead();
 
-  inline void busy_sleep(std::chrono::nanoseconds t) const;
+  TickPacer pacer_{overhead_};
+
+  // Waits until every thread finishes the current tick.
+  // The last thread to arrive waits for the beginning of the next tick and
+  // advances it.
+  void ThreadReady();
 
-  void ThreadReady(std::thread::id id);
+  // Executed by the last thread that arrived to the barrier, while other
+  // threads are waiting.
+  void OnTickEnd();
 
-  Core();
+  explicit Core(CoreConfig config);
 
+  [[nodiscard]] static uint32_t ThreadCount(CoreConfig const& config);
+  // CPUs of the update threads in the order of the threads, empty if the
+  // threads aren't pinned.
+  [[nodiscard]] std::vector<uint32_t> WorkerCpus() const;
+
+  // The Core static functions refer to.
+  [[nodiscard]] static Core& Current() noexcept;
+
+  // Core of the update thread, nullptr on other threads.
+  static thread_local Core* current_;
+  // Core of GetInstance for the static functions.
+  static std::atomic<Core*> instance_;
 
   static std::mutex core_creation_mutex_;
   static std::shared_ptr<Core> core_ptr_;
+  // guarded by core_creation_mutex_
+  static CoreConfig pending_config_;
+
+  const CoreConfig config_;
+  const uint32_t thread_count_;
+  TickBarrier barrier_{thread_count_};
+
+  std::array<Phase, phase::kMaxPhases> phases_;
+  // amount of phases which are executed, changed only between ticks
+  size_t phase_count_ = 0;
+  // amount of declared phases, the new ones are activated between ticks
+  std::atomic<size_t> declared_phase_count_ = 0;
+  std::mutex phases_mutex_;
+
+
+  // Written only between ticks, atomics are used because they are read from
+  // threads which are not synchronized with the tick, e.g. the render thread.
+  std::atomic<uint64_t> last_tick_timestamp_ = 0;
+  std::atomic<uint64_t> last_tick_timedelta_ = 0;
+
+  // wall clock time of the beginning of the tick, used for pacing and by
+  // interpolation_alpha
+  std::atomic<uint64_t> last_tick_wall_ns_ = 0;
+
+  // state of RebalanceThreads, used only between ticks
+  bool rebalancing_ = false;
+  uint32_t imbalanced_checks_ = 0;
+  std::atomic<uint64_t> rebalances_ = 0;
+  std::atomic<uint64_t> migrations_ = 0;
+  std::atomic<double> imbalance_before_ = 0;
+  std::atomic<double> imbalance_after_ = 0;
+
+  // state of the overload policy, changed only between ticks
+  std::atomic<bool> overload_control_ = false;
+  std::atomic<uint32_t> overload_level_ = 0;
+  uint32_t recovery_ticks_ = 0;
+  std::atomic<uint64_t> overrun_ticks_ = 0;
+  std::atomic<uint64_t> degraded_ticks_ = 0;
+  std::atomic<uint64_t> max_overrun_ns_ = 0;
 
-  std::thread::id operational_thread_id_;
-  std::mutex sync_mutex_;
-  std::condition_variable sync_var_;
-  size_t sync_threads_ = 0;
+  // requested mode, copied into deterministic_ between ticks
+  std::atomic<bool> deterministic_requested_ = false;
+  // set by the first added object or task, see SetDeterministic
+  std::atomic<bool> has_objects_ = false;
+  // constant during the tick
+  bool deterministic_ = false;
 
+  // Written only between ticks.
+  std::atomic<uint64_t> global_tick_ = 0;
 
-  double last_tick_timestamp_ = 0;
-  double last_tick_timedelta_ = 0;
+  // The Core holds before ticks starting from tick_limit_, kFreeRunning if it
+  // ticks on its own.
+  static constexpr uint64_t kFreeRunning = UINT64_MAX;
+  std::atomic<uint64_t> tick_limit_ = kFreeRunning;
+  std::atomic<bool> stop_requested_ = false;
+  // set when the threads leave the tick loop, changed only between ticks
+  bool stopping_ = false;
+  // the update threads wait for the end of the constructor
+  std::atomic<bool> started_ = false;
+  // guards the state below and wakes RunTicks and the held Core
+  std::mutex control_mutex_;
+  std::condition_variable control_;
+  bool held_ = false;
 
-  uint64_t global_tick_ = 0;
+  // see Spawn
+  std::atomic<size_t> task_count_ = 0;
+  std::atomic<size_t> next_task_thread_ = 0;
+  // started on the first co_await Background
+  BackgroundWorkers background_{config_.background_threads};
 
-  const uint32_t tickrate_ = 64;
+  // requested tickrate, copied into tickrate_ between ticks
+  std::atomic<uint32_t> tickrate_requested_;
+  std::atomic<uint32_t> tickrate_;
 
+  // filled in the constructor and never changed afterwards
   std::vector<std::unique_ptr<UpdateThread>> threads_;
-  std::mutex threads_mutex_;
 };
 }  // namespace engine::core
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+#include "BatchTicker.h"
+#include "engine/core/TransformHierarchy.h"
+
+namespace engine::core {
+/// <summary>
+/// Propagates the world matrices of a TransformHierarchy every tick.
+/// The owner thread propagates the dirty subtrees down to the depth where
+/// they become TransformHierarchy::kParallelWidth wide, the nodes of that
+/// depth are the instances of the batch, so the Core splits them with their
+/// subtrees between the update threads.
+///
+/// It runs in phase::kPostUpdate, after the objects have moved in
+/// phase::kUpdate, and is never skipped by the overload policy. Objects
+/// shouldn't be added, removed or reparented during kPostUpdate.
+/// </summary>
+class HierarchyTicker : public BatchTickerBase {
+ public:
+  // Nodes per chunk, each one with its whole subtree.
+  static constexpr size_t kGrain = 64;
+
+  explicit HierarchyTicker(
+      TransformHierarchy& hierarchy = TransformHierarchy::Global())
+      : BatchTickerBase(1), hierarchy_(hierarchy) {
+    SetPhase(phase::kPostUpdate);
+    SetPriority(TickPriority::kCritical);
+    SetGrain(kGrain);
+  }
+
+  [[nodiscard]] size_t batch_size() const noexcept final { return split_; }
+
+ protected:
+  void PrepareBatch(const uint64_t) final {
+    split_ = hierarchy_.PrepareParallel();
+  }
+  void UpdateRange(uint64_t, size_t begin, size_t end) final {
+    hierarchy_.PropagateRange(begin, end);
+  }
+
+ private:
+  TransformHierarchy& hierarchy_;
+  size_t split_ = 0;
+};
+}  // namespace engine::core
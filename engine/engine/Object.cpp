@@ -1,131 +1,198 @@
-
 #include "Object.h"
 
 namespace engine::core {
 [[nodiscard]] glm::mat4 Object::translation_matrix() const noexcept {
-  return translation_matrix_;
+  return glm::translate(glm::mat4(1.0F), position());
 }
 [[nodiscard]] glm::mat4 Object::rotation_matrix() const noexcept { 
-  return rotation_matrix_; 
+  return glm::mat4_cast(rotation()); 
 }
 [[nodiscard]] glm::mat4 Object::scale_matrix() const noexcept { 
-  return scale_matrix_; 
+  return glm::scale(glm::mat4(1.0F), scale()); 
 }
 
 [[nodiscard]] glm::mat4 Object::model_matrix() noexcept {
-  UpdateModelMatrix();
-  return full_matrix_;
+  TransformStore& store = TransformStore::Global();
+  store.UpdateModelMatrix(transform_);
+  return store.model_matrix(transform_);
+}
+
+bool Object::SetParent(Object* parent) {
+  TransformHierarchy& hierarchy = TransformHierarchy::Global();
+  if (parent == nullptr) {
+    const NodeHandle node = this->node();
+    return !node.valid() || hierarchy.SetParent(node, {});
+  }
+  return hierarchy.SetParent(EnsureNode(), parent->EnsureNode());
+}
+
+[[nodiscard]] glm::mat4 Object::world_matrix() noexcept {
+  const NodeHandle node = this->node();
+  if (!node.valid()) {
+    return model_matrix();
+  }
+  return TransformHierarchy::Global().world_matrix(node);
+}
+
+NodeHandle Object::EnsureNode() {
+  NodeHandle node = this->node();
+  if (node.valid()) {
+    return node;
+  }
+  const NodeHandle added = TransformHierarchy::Global().Add(transform_);
+  if (!node_.compare_exchange_strong(node, added, std::memory_order_acq_rel)) {
+    // another thread was faster, node holds its handle
+    TransformHierarchy::Global().Remove(added);
+    return node;
+  }
+  RenderSnapshots::Global().SetNode(snapshot_id_, added);
+  return added;
+}
+
+void Object::MarkNodeDirty() noexcept {
+  if (const NodeHandle node = node_.load(std::memory_order_relaxed);
+      node.valid()) {
+    TransformHierarchy::Global().MarkDirty(node);
+  }
 }
 
 [[nodiscard]] glm::vec3 Object::position() const noexcept {
-  return glm::vec3(translation_matrix_[3][0], translation_matrix_[3][1],
-                   translation_matrix_[3][2]);
+  return TransformStore::Global().position(transform_);
 }
 [[nodiscard]] glm::vec3 Object::scale() const noexcept {
-  return glm::vec3(scale_matrix_[0][0], scale_matrix_[1][1],
-                   scale_matrix_[2][2]);
+  return TransformStore::Global().scale(transform_);
+}
+
+glm::quat Object::rotation() const noexcept {
+  return TransformStore::Global().rotation(transform_);
+}
+
+void Object::SetRotation(glm::quat const& rotation) noexcept {
+  TransformStore::Global().SetRotation(transform_, glm::normalize(rotation));
+  MarkNodeDirty();
 }
 
 void Object::Move(glm::vec3 const& coords) noexcept {
-  translation_matrix_ = glm::translate(translation_matrix_, coords);
+  SetPosition(position() + coords);
 }
 
 void Object::Move(const float x, const float y, const float z) noexcept {
-  translation_matrix_ = glm::translate(translation_matrix_, glm::vec3(x, y, z));
+  SetPosition(position() + glm::vec3(x, y, z));
 }
 
 void Object::SetTranslationMatrix(glm::mat4 const& mat) noexcept {
-  this->translation_matrix_ = mat;
+  this->SetPosition(glm::vec3(mat[3]));
 }
 void Object::SetPosition(glm::vec3 const& pos) noexcept {
-  this->translation_matrix_ = glm::translate(glm::mat4(1.0F), pos);
+  TransformStore::Global().SetPosition(transform_, pos);
+  MarkNodeDirty();
 }
 
+namespace {
+// Euler angles are applied in the order x, y, z in the local space, like
+// the RotateX, RotateY, RotateZ calls did, but as a single rotation.
+glm::quat EulerRotation(const float anglex, const float angley,
+                        const float anglez) noexcept {
+  return glm::angleAxis(anglex, glm::vec3(1.0F, 0.0F, 0.0F)) *
+         glm::angleAxis(angley, glm::vec3(0.0F, 1.0F, 0.0F)) *
+         glm::angleAxis(anglez, glm::vec3(0.0F, 0.0F, 1.0F));
+}
+}  // namespace
+
 void Object::Rotate(const float anglex, const float angley,
                     const float anglez) noexcept {
-  RotateX(anglex);
-  RotateY(angley);
-  RotateZ(anglez);
+  Rotate(EulerRotation(anglex, angley, anglez));
 }
 
 void Object::Rotate(const glm::vec3 angle) noexcept {
   this->Rotate(angle.x, angle.y, angle.z);
 }
 
+// rotations are applied in the local space of the object, like
+// glm::rotate(rotation_matrix, ..) did. The quaternion is normalised after
+// every rotation, so the error doesn't accumulate in long-lived objects.
+void Object::Rotate(glm::quat const& delta) noexcept {
+  SetRotation(rotation() * delta);
+}
+
+void Object::Rotate(const float angle, glm::vec3 const& axis) noexcept {
+  Rotate(glm::angleAxis(angle, glm::normalize(axis)));
+}
+
+void Object::RotateGlobal(glm::quat const& delta) noexcept {
+  SetRotation(delta * rotation());
+}
+
 void Object::RotateX(const float angle) noexcept {
-  rotation_matrix_ =
-      glm::rotate(rotation_matrix_, angle, glm::vec3(1.0F, 0.0F, 0.0F));
+  Rotate(glm::angleAxis(angle, glm::vec3(1.0F, 0.0F, 0.0F)));
 }
 
 void Object::RotateY(const float angle) noexcept {
-  rotation_matrix_ =
-      glm::rotate(rotation_matrix_, angle, glm::vec3(0.0F, 1.0F, 0.0F));
+  Rotate(glm::angleAxis(angle, glm::vec3(0.0F, 1.0F, 0.0F)));
 }
 
 void Object::RotateZ(const float angle) noexcept {
-  rotation_matrix_ =
-      glm::rotate(rotation_matrix_, angle, glm::vec3(0.0F, 0.0F, 1.0F));
+  Rotate(glm::angleAxis(angle, glm::vec3(0.0F, 0.0F, 1.0F)));
+}
+
+void Object::RotateTowards(glm::quat const& target, const float t) noexcept {
+  // glm::slerp takes the shorter arc
+  SetRotation(glm::slerp(rotation(), glm::normalize(target), t));
+}
+
+void Object::LookAt(glm::vec3 const& target, glm::vec3 const& up) noexcept {
+  const glm::vec3 direction = target - position();
+  if (glm::dot(direction, direction) < 1e-12F) {
+    return;
+  }
+  const glm::vec3 forward = glm::normalize(direction);
+  glm::vec3 up_axis = glm::normalize(up);
+  // quatLookAt is undefined when up is parallel to the direction
+  if (std::abs(glm::dot(forward, up_axis)) > 0.9999F) {
+    up_axis = std::abs(forward.z) < 0.9F ? glm::vec3(0.0F, 0.0F, 1.0F)
+                                         : glm::vec3(1.0F, 0.0F, 0.0F);
+  }
+  SetRotation(glm::quatLookAt(forward, up_axis));
+}
+
+glm::vec3 Object::forward() const noexcept {
+  return rotation() * glm::vec3(0.0F, 0.0F, -1.0F);
 }
 
 void Object::SetRotationMatrix(glm::mat4 const& mat) noexcept {
-  this->rotation_matrix_ = mat;
+  this->SetRotation(glm::quat_cast(mat));
 }
 void Object::SetRotation(glm::vec3 const& angle) noexcept {
-  this->rotation_matrix_ = glm::mat4(1.0F);
-  this->RotateX(angle.x);
-  this->RotateY(angle.y);
-  this->RotateZ(angle.z);
+  this->SetRotation(EulerRotation(angle.x, angle.y, angle.z));
 }
 void Object::SetRotation(const float anglex, const float angley,
                          const float anglez) noexcept {
-  this->rotation_matrix_ = glm::mat4(1.0F);
-  this->RotateX(anglex);
-  this->RotateY(angley);
-  this->RotateZ(anglez);
+  this->SetRotation(EulerRotation(anglex, angley, anglez));
 }
 
 void Object::Scale(glm::vec3 const& scale) noexcept {
-  scale_matrix_ = glm::scale(scale_matrix_, scale);
+  SetScale(this->scale() * scale);
 }
 
 void Object::Scale(const int x, const int y, const int z) noexcept {
-  scale_matrix_ = glm::scale(scale_matrix_, glm::vec3(x, y, z));
+  SetScale(scale() * glm::vec3(x, y, z));
 }
 void Object::ScaleX(const int scale) noexcept {
-  scale_matrix_ = glm::scale(scale_matrix_, glm::vec3(scale, 0, 0));
+  SetScale(this->scale() * glm::vec3(scale, 0, 0));
 }
 void Object::ScaleY(const int scale) noexcept {
-  scale_matrix_ = glm::scale(scale_matrix_, glm::vec3(0, scale, 0));
+  SetScale(this->scale() * glm::vec3(0, scale, 0));
 }
 void Object::ScaleZ(const int scale) noexcept {
-  scale_matrix_ = glm::scale(scale_matrix_, glm::vec3(0, 0, scale));
+  SetScale(this->scale() * glm::vec3(0, 0, scale));
 }
 
 void Object::SetScaleMatrix(glm::mat4 const& mat) noexcept {
-  this->scale_matrix_ = mat;
+  this->SetScale(glm::vec3(mat[0][0], mat[1][1], mat[2][2]));
 }
 
 void Object::SetScale(glm::vec3 const& scale) noexcept {
-  this->scale_matrix_ = glm::scale(glm::mat4(1.0F), scale);
-}
-
-
-void Object::UpdateModelMatrix() noexcept {
-  bool flag = false;
-  if (translation_matrix_buf_ != translation_matrix_) {
-    translation_matrix_buf_ = translation_matrix_;
-    flag = true;
-  }
-  if (rotation_matrix_buf_ != rotation_matrix_) {
-    rotation_matrix_buf_ = rotation_matrix_;
-    flag = true;
-  }
-  if (scale_matrix_buf_ != scale_matrix_) {
-    scale_matrix_buf_ = scale_matrix_;
-    flag = true;
-  }
-  if (flag) {
-    full_matrix_ = translation_matrix_ * rotation_matrix_ * scale_matrix_;
-  }
+  TransformStore::Global().SetScale(transform_, scale);
+  MarkNodeDirty();
 }
-}  // namespace engine::core
\ No newline at end of file
+}  // namespace engine::core
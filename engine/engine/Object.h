@@ -4,16 +4,24 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <string>
 
 #include "Ticker.h"
-#include "engine/client/render/Renderer.h"
+#include "engine/core/RenderSnapshots.h"
+#include "engine/core/TransformHierarchy.h"
+#include "engine/core/TransformStore.h"
 
 namespace engine::client::render {
 class Renderer;
 }
 namespace engine::core {
+// Position, rotation and scale of the object are stored in
+// TransformStore::Global(), the object holds a handle to them. Objects with a
+// parent or children also have a node in TransformHierarchy::Global(), their
+// transform is relative to the parent. The render thread reads the world
+// matrix from RenderSnapshots::Global() instead of the store.
 class Object : public Ticker {
  public:
   explicit Object(const uint32_t tickrate, glm::vec3 coords = glm::vec3(0.0F),
@@ -33,6 +41,14 @@ class Object : public Ticker {
     this->Rotate(angle);
     this->Scale(scale);
   }
+  ~Object() override {
+    RenderSnapshots::Global().Remove(snapshot_id_);
+    if (const NodeHandle node = node_.load(std::memory_order_relaxed);
+        node.valid()) {
+      TransformHierarchy::Global().Remove(node);
+    }
+    TransformStore::Global().Remove(transform_);
+  }
 
 
   [[nodiscard]] virtual std::shared_ptr<engine::client::render::Renderer>
@@ -45,8 +61,38 @@ class Object : public Ticker {
   [[nodiscard]] glm::mat4 translation_matrix() const noexcept;
   [[nodiscard]] glm::mat4 rotation_matrix() const noexcept;
   [[nodiscard]] glm::mat4 scale_matrix() const noexcept;
+  // Rebuilds the matrix if the transform has changed, see
+  // TransformStore::UpdateModelMatrices for many objects at once.
   [[nodiscard]] glm::mat4 model_matrix() noexcept;
 
+  // Handle of the transform in TransformStore::Global().
+  [[nodiscard]] TransformHandle transform() const noexcept {
+    return transform_;
+  }
+
+  // Makes the transform of the object relative to the parent, nullptr makes
+  // the object a root again. Returns false if the parent is a descendant of
+  // the object. Shouldn't be called while the hierarchy is propagated, see
+  // HierarchyTicker.
+  bool SetParent(Object* parent);
+  // Node in TransformHierarchy::Global(), invalid until the object gets a
+  // parent or a child.
+  [[nodiscard]] NodeHandle node() const noexcept {
+    return node_.load(std::memory_order_acquire);
+  }
+  // Model matrix times the world matrices of the parents as of the last
+  // propagation, model_matrix() for objects without a node.
+  [[nodiscard]] glm::mat4 world_matrix() noexcept;
+
+  // Id of the object in RenderSnapshots::Global().
+  [[nodiscard]] uint32_t snapshot_id() const noexcept { return snapshot_id_; }
+  // World matrix in the snapshot acquired by the render thread, see
+  // RenderSnapshots::Acquire. Should be called only by the render thread,
+  // unlike world_matrix() it doesn't race with the objects moving.
+  [[nodiscard]] glm::mat4 snapshot_matrix() const noexcept {
+    return RenderSnapshots::Global().front().world_matrix(snapshot_id_);
+  }
+
   [[nodiscard]] glm::vec3 position() const noexcept;
   [[nodiscard]] glm::vec3 scale() const noexcept;
 
@@ -54,7 +100,7 @@ class Object : public Ticker {
   void Move(glm::vec3 const& coords) noexcept;
   // move object by this coords(object.x += coords.x, object.y += coords.y etc.)
   void Move(const float x, const float y, const float z) noexcept;
-  // set translation matrix
+  // set translation matrix, only the translation part is kept
   void SetTranslationMatrix(glm::mat4 const& mat) noexcept;
   // set current position
   void SetPosition(glm::vec3 const& pos) noexcept;
@@ -75,7 +121,7 @@ class Object : public Ticker {
   // angle should be defined in radians
   // rotate object by given angle
   void RotateZ(const float angle) noexcept;
-  // set rotation matrix
+  // set rotation matrix, it should be a pure rotation
   void SetRotationMatrix(glm::mat4 const& mat) noexcept;
   // set rotation angles
   void SetRotation(glm::vec3 const& angle) noexcept;
@@ -83,6 +129,28 @@ class Object : public Ticker {
   void SetRotation(const float anglex, const float angley,
                    const float anglez) noexcept;
 
+  // The rotation is stored as a normalised quaternion, rotation_matrix() is
+  // built from it only when requested.
+  [[nodiscard]] glm::quat rotation() const noexcept;
+  // set rotation, it is normalised
+  void SetRotation(glm::quat const& rotation) noexcept;
+  // rotate object by the quaternion in its local space
+  void Rotate(glm::quat const& delta) noexcept;
+  // angle should be defined in radians
+  // rotate object around the axis of its local space
+  void Rotate(const float angle, glm::vec3 const& axis) noexcept;
+  // rotate object by the quaternion in the space of its parent
+  void RotateGlobal(glm::quat const& delta) noexcept;
+  // rotate object along the shortest arc towards the target, t = 1 reaches
+  // it, e.g. t = min(1, speed * Core::tick_delta()) every update
+  void RotateTowards(glm::quat const& target, const float t) noexcept;
+  // turn the -Z axis of the object towards the point, in the space of its
+  // parent. Nothing happens if the point is the position of the object.
+  void LookAt(glm::vec3 const& target,
+              glm::vec3 const& up = glm::vec3(0.0F, 1.0F, 0.0F)) noexcept;
+  // direction of the -Z axis of the object
+  [[nodiscard]] glm::vec3 forward() const noexcept;
+
   // scale object by value (transforms current scale)
   void Scale(glm::vec3 const& scale) noexcept;
   // scale object by value (transforms current scale)
@@ -93,21 +161,22 @@ class Object : public Ticker {
   void ScaleY(const int scale) noexcept;
   // scale object by value (transforms current scale)
   void ScaleZ(const int scale) noexcept;
-  // set scale matrix
+  // set scale matrix, only the diagonal is kept
   void SetScaleMatrix(glm::mat4 const& mat) noexcept;
   // set current scale
   void SetScale(glm::vec3 const& scale) noexcept;
 
  private:
-  void UpdateModelMatrix() noexcept;
-
-  glm::mat4 translation_matrix_ = glm::mat4(1.0F);
-  glm::mat4 rotation_matrix_ = glm::mat4(1.0F);
-  glm::mat4 scale_matrix_ = glm::mat4(1.0F);
-  glm::mat4 full_matrix_ = glm::mat4(1.0F);
+  // Adds the node on the first use.
+  NodeHandle EnsureNode();
+  // Lets the hierarchy rebuild the world matrices of the subtree.
+  void MarkNodeDirty() noexcept;
 
-  glm::mat4 translation_matrix_buf_ = glm::mat4(1.0F);
-  glm::mat4 rotation_matrix_buf_ = glm::mat4(1.0F);
-  glm::mat4 scale_matrix_buf_ = glm::mat4(1.0F);
+  // initialised before the constructor body moves the object
+  const TransformHandle transform_ = TransformStore::Global().Add(
+      glm::vec3(0.0F), glm::quat(1.0F, 0.0F, 0.0F, 0.0F), glm::vec3(1.0F));
+  const uint32_t snapshot_id_ = RenderSnapshots::Global().Add(transform_);
+  // set once, the parent can add it from another thread
+  std::atomic<NodeHandle> node_;
 };
 }  // namespace engine::core
\ No newline at end of file
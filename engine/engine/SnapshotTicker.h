@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+
+#include "BatchTicker.h"
+#include "Core.h"
+#include "engine/core/RenderSnapshots.h"
+
+namespace engine::core {
+/// <summary>
+/// Captures and publishes a RenderSnapshots snapshot every tick. The
+/// renderables are the instances of the batch, the chunk which finishes the
+/// capture publishes it.
+///
+/// The phase should depend on phase::kPostUpdate, so the hierarchy is
+/// propagated, and shouldn't overlap the next tick, otherwise the objects
+/// would move during the capture, e.g.
+/// core->DeclarePhase("Snapshot", {phase::kPostUpdate}). It is never skipped
+/// by the overload policy.
+/// </summary>
+class SnapshotTicker : public BatchTickerBase {
+ public:
+  // Renderables per chunk.
+  static constexpr size_t kGrain = 1024;
+
+  explicit SnapshotTicker(
+      const PhaseId phase,
+      RenderSnapshots& snapshots = RenderSnapshots::Global())
+      : BatchTickerBase(1), snapshots_(snapshots) {
+    SetPhase(phase);
+    SetPriority(TickPriority::kCritical);
+    SetGrain(kGrain);
+  }
+
+  [[nodiscard]] size_t batch_size() const noexcept final { return size_; }
+
+ protected:
+  void PrepareBatch(const uint64_t tick) final {
+    size_ = snapshots_.BeginCapture(tick, Core::tick_time_ns());
+    remaining_.store(size_, std::memory_order_relaxed);
+    if (size_ == 0) {
+      snapshots_.Publish();
+    }
+  }
+  void UpdateRange(uint64_t, size_t begin, size_t end) final {
+    if (begin == end) {
+      return;
+    }
+    snapshots_.CaptureRange(begin, end);
+    if (remaining_.fetch_sub(end - begin, std::memory_order_acq_rel) ==
+        end - begin) {
+      snapshots_.Publish();
+    }
+  }
+
+ private:
+  RenderSnapshots& snapshots_;
+  size_t size_ = 0;
+  // renderables left to capture in this tick
+  std::atomic<size_t> remaining_ = 0;
+};
+}  // namespace engine::core
@@ -0,0 +1,193 @@
+#pragma once
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "engine/core/TickPhase.h"
+
+namespace engine::core {
+class Core;
+
+/// <summary>
+/// Coroutine for behaviours which span many ticks, e.g. a door which opens
+/// over a second or an AI plan with several stages:
+///
+///   TickTask OpenDoor(Door& door) {
+///     for (int i = 0; i < 64; i++) {
+///       door.angle += 90.0f / 64;
+///       co_await NextTick();
+///     }
+///     co_await Ticks(128);
+///     door.mesh = co_await Background([] { return LoadMesh("open.mesh"); });
+///   }
+///   core->Spawn(OpenDoor(door));
+///
+/// The Core resumes the task at the beginning of its phase on one update
+/// thread, before the phase is finished, so the task can touch the same
+/// state as the Update of the phase. A suspended task costs nothing until it
+/// is due: it isn't polled, it waits in a per-thread queue ordered by the
+/// tick it resumes in.
+///
+/// A task can co_await another TickTask, which runs in the same phase and
+/// resumes the caller when it returns. Tasks which are still suspended when
+/// the Core is destroyed are destroyed with it, so their locals are released
+/// but they don't run to the end.
+/// </summary>
+class TickTask {
+ public:
+  struct promise_type;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  struct promise_type {
+    [[nodiscard]] TickTask get_return_object() noexcept {
+      return TickTask(Handle::from_promise(*this));
+    }
+    // the task starts when the Core resumes it the first time
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    auto final_suspend() noexcept {
+      struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        std::coroutine_handle<> await_suspend(Handle handle) noexcept {
+          auto continuation = handle.promise().continuation_;
+          return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+      };
+      return FinalAwaiter{};
+    }
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+
+    // Resumes the task in its phase of tick + ticks. Defined in Core.cpp.
+    void ResumeAfter(uint64_t ticks);
+    // Runs the job on the background threads of the Core and resumes the
+    // task in its phase of the next tick after the job. Defined in Core.cpp.
+    void ResumeAfterJob(std::function<void()> job);
+
+   private:
+    friend class Core;
+    friend class TickTask;
+
+    // set by Core::Spawn, nested tasks copy them from the caller
+    Core* core_ = nullptr;
+    uint32_t thread_ = 0;
+    PhaseId phase_ = 0;
+    // the spawned task, destroyed by the Core once it is done
+    Handle root_;
+    // task which co_awaits this one
+    std::coroutine_handle<> continuation_;
+  };
+
+  TickTask() noexcept = default;
+  TickTask(TickTask&& other) noexcept
+      : handle_(std::exchange(other.handle_, {})) {}
+  TickTask& operator=(TickTask&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+  TickTask(const TickTask&) = delete;
+  TickTask& operator=(const TickTask&) = delete;
+  ~TickTask() { Reset(); }
+
+  [[nodiscard]] bool valid() const noexcept { return bool(handle_); }
+
+  // co_await of a nested task runs it right away in the same phase.
+  [[nodiscard]] bool await_ready() const noexcept {
+    return !handle_ || handle_.done();
+  }
+  Handle await_suspend(Handle caller) noexcept {
+    promise_type& callee = handle_.promise();
+    promise_type const& parent = caller.promise();
+    callee.core_ = parent.core_;
+    callee.thread_ = parent.thread_;
+    callee.phase_ = parent.phase_;
+    callee.root_ = parent.root_;
+    callee.continuation_ = caller;
+    return handle_;
+  }
+  void await_resume() const noexcept {}
+
+ private:
+  friend class Core;
+
+  explicit TickTask(Handle handle) noexcept : handle_(handle) {}
+
+  void Reset() noexcept {
+    if (handle_) {
+      handle_.destroy();
+      handle_ = {};
+    }
+  }
+
+  Handle handle_;
+};
+
+// Suspends the task for the given amount of ticks, zero doesn't suspend.
+class TickAwaiter {
+ public:
+  explicit TickAwaiter(uint64_t ticks) noexcept : ticks_(ticks) {}
+
+  [[nodiscard]] bool await_ready() const noexcept { return ticks_ == 0; }
+  void await_suspend(TickTask::Handle handle) const {
+    handle.promise().ResumeAfter(ticks_);
+  }
+  void await_resume() const noexcept {}
+
+ private:
+  uint64_t ticks_;
+};
+
+// The task continues in its phase of the next tick.
+[[nodiscard]] inline TickAwaiter NextTick() noexcept { return TickAwaiter(1); }
+
+// The task continues in its phase n ticks later.
+[[nodiscard]] inline TickAwaiter Ticks(uint64_t n) noexcept {
+  return TickAwaiter(n);
+}
+
+// Runs the job on a background thread, see BackgroundWorkers, and returns
+// its result. The task continues in its phase of the tick after the job.
+template <typename Job>
+class BackgroundAwaiter {
+ public:
+  using Result = std::invoke_result_t<Job&>;
+
+  explicit BackgroundAwaiter(Job job) : job_(std::move(job)) {}
+
+  [[nodiscard]] bool await_ready() const noexcept { return false; }
+  void await_suspend(TickTask::Handle handle) {
+    // the awaiter lives in the suspended frame until the task is resumed
+    handle.promise().ResumeAfterJob([this]() {
+      if constexpr (std::is_void_v<Result>) {
+        job_();
+      } else {
+        result_.emplace(job_());
+      }
+    });
+  }
+  Result await_resume() {
+    if constexpr (!std::is_void_v<Result>) {
+      return std::move(*result_);
+    }
+  }
+
+ private:
+  struct Empty {};
+
+  Job job_;
+  std::conditional_t<std::is_void_v<Result>, Empty, std::optional<Result>>
+      result_;
+};
+
+template <typename Job>
+[[nodiscard]] BackgroundAwaiter<Job> Background(Job job) {
+  return BackgroundAwaiter<Job>(std::move(job));
+}
+}  // namespace engine::core
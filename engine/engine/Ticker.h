@@ -1,9 +1,27 @@
 #pragma once
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <thread>
+
+#include "engine/core/Clock.h"
+#include "engine/core/LatencyHistogram.h"
+#include "engine/core/TickPhase.h"
+#include "engine/core/TickerHandle.h"
+#include "engine/core/Trace.h"
 namespace engine::core {
+// What the Core may give up when a tick overruns its budget, if the overload
+// policy is enabled, see Core::SetOverloadControl. Critical objects are always
+// updated at their full tickrate, normal ones are halved only at the highest
+// overload level, low priority objects are updated at half rate first and
+// then skipped.
+enum class TickPriority : uint8_t { kCritical, kNormal, kLow };
+
 class Ticker {
  public:
+  // The Core chooses the tick offset, see TickSchedule.
+  static constexpr uint32_t kAutoTickOffset = UINT32_MAX;
+
   /// <summary>
   /// Ticker class constructor.
   /// If tickrate is zero, 
@@ -19,24 +37,20 @@ class Ticker {
   virtual ~Ticker() = default;
 
   /// <summary>
-  ///
+  /// Calls Update and measures its execution time.
+  /// Core calls it only on ticks on which the object is due, see
+  /// TickSchedule.
   /// </summary>
-  /// <param name="tick"></param>
-  /// <param name="time_delta"></param>
+  /// <param name="tick">current engine tick</param>
   void UpdateExecutionTime(const uint64_t tick) {
-    if ( (tick % tickrate() != 0) || !needs_update_) {
+    if (!needs_update_) {
       return;
     }
-    auto start = std::chrono::high_resolution_clock::now();
+    const uint64_t start = Clock::now_ns();
     Update(tick);
-    double exec_time =
-        (double(std::chrono::duration_cast<std::chrono::nanoseconds>(
-                    std::chrono::high_resolution_clock::now() - start)
-                    .count())) /
-        10e9;
-    this->average_update_time_ =
-        average_update_time_ * double(calls_counter_) + exec_time;
-    this->average_update_time_ /= ++calls_counter_;
+    const uint64_t end = Clock::now_ns();
+    ENGINE_TRACE_RECORD("Ticker::Update", start, end);
+    RecordExecutionTime(end - start, end);
   }
   /// <summary>
   /// 
@@ -56,7 +70,9 @@ class Ticker {
   }
 
   /// <summary>
-  /// Returns average Update execution time(in seconds).
+  /// Returns average Update execution time(in seconds) over the whole
+  /// lifetime of the object. It hides the recent changes and the spikes, see
+  /// latency().
   /// </summary>
   /// <returns>Average Update execution time.</returns>
   [[nodiscard]] double average_update_time() const noexcept {
@@ -64,25 +80,101 @@ class Ticker {
   }
   [[nodiscard]] int calls_counter() const noexcept { return calls_counter_; }
 
+  // Update execution time over the last one to two seconds, p50/p99/p999 and
+  // max. Can be read from any thread.
+  [[nodiscard]] LatencyHistogram const& latency() const noexcept {
+    return latency_;
+  }
+
   [[nodiscard]] bool needs_update() const noexcept { return needs_update_; }
 
+  // Phase of the tick in which the Update function is called.
+  [[nodiscard]] PhaseId phase() const noexcept { return phase_; }
+
+  // The object is updated on ticks where tick % tickrate == offset % tickrate.
+  // kAutoTickOffset by default.
+  [[nodiscard]] uint32_t tick_offset() const noexcept { return tick_offset_; }
+
+  // kNormal by default.
+  [[nodiscard]] TickPriority priority() const noexcept {
+    return priority_.load(std::memory_order_relaxed);
+  }
+
+  // Handle of the object in the Core, invalid if the object isn't registered
+  // yet or was removed.
+  [[nodiscard]] TickerHandle handle() const noexcept { return handle_; }
+
+  // Index of the update thread which owns the object, in the order of
+  // Core::thread_ids(). Jobs of the object may still be stolen by others.
+  [[nodiscard]] uint32_t owner_thread() const noexcept {
+    return owner_thread_.load(std::memory_order_relaxed);
+  }
+
  protected:
   void SetTickrate(uint32_t tickrate) { tickrate_ = tickrate; }
   void SetThreadID(std::thread::id &id) {
     thread_id_ = std::make_shared<std::thread::id>(id);
   }
 
+  // Should be called before the object is added to the Core.
+  void SetPhase(PhaseId phase) noexcept { phase_ = phase; }
+
+  // Should be called before the object is added to the Core. Objects which
+  // should be updated on the same ticks, e.g. to observe each other's state,
+  // should have the same offset.
+  void SetTickOffset(uint32_t offset) noexcept { tick_offset_ = offset; }
+
+  // Can be changed at any time, takes effect from the next tick.
+  void SetPriority(TickPriority priority) noexcept {
+    priority_.store(priority, std::memory_order_relaxed);
+  }
+
+  // Adds one update which took duration_ns and has finished at end_ns to
+  // latency() and average_update_time().
+  void RecordExecutionTime(uint64_t duration_ns, uint64_t end_ns) noexcept {
+    latency_.Record(duration_ns, end_ns);
+    const double exec_time = double(duration_ns) / 1e9;
+    this->average_update_time_ =
+        average_update_time_ * double(calls_counter_) + exec_time;
+    this->average_update_time_ /= ++calls_counter_;
+  }
+
   void DisableUpdating() { needs_update_ = false; }
   void EnableUpdating() { needs_update_ = true; }
 
  private:
+  friend class BatchTickerBase;
+  friend class Core;
+  friend class TickerRegistry;
+  friend class TickSchedule;
+
   uint32_t tickrate_;
   int calls_counter_ = 0;
   double average_update_time_ = 0;
 
   bool needs_update_ = true;
 
+  PhaseId phase_ = phase::kUpdate;
+  uint32_t tick_offset_ = kAutoTickOffset;
+  std::atomic<TickPriority> priority_ = TickPriority::kNormal;
+  // set by BatchTickerBase, so the Core doesn't need dynamic_cast
+  bool batched_ = false;
+
+  // Where the Core keeps the object, maintained by the friends above.
+  TickerHandle handle_;
+  // index of the UpdateThread which owns the object, changes when the object
+  // migrates to another thread
+  std::atomic<uint32_t> owner_thread_ = 0;
+  // bucket of the TickSchedule and the index inside of it, scheduled_tickrate_
+  // is zero if the object isn't scheduled
+  uint32_t scheduled_tickrate_ = 0;
+  uint32_t scheduled_offset_ = 0;
+  uint32_t scheduled_index_ = 0;
+
   std::shared_ptr<std::thread::id> thread_id_ =
       std::shared_ptr<std::thread::id>(nullptr);
+
+  // the last one, so the fields above share cache lines
+  LatencyHistogram latency_;
 };
 }  // namespace engine::core
\ No newline at end of file
@@ -47,6 +47,32 @@ void Input::StaticDropCallback(GLFWwindow* window, int path_count,
 }
 
 void Input::Update(const uint64_t) {
+  {
+    std::scoped_lock<std::mutex> lock(key_events_mutex_);
+    if (replaying_) {
+      // live events are dropped, so they don't mix with the replayed ones
+      pending_key_events_.clear();
+      auto const& events = replay_.events();
+      for (; replay_position_ < events.size() &&
+             events[replay_position_].tick <= replay_tick_;
+           replay_position_++) {
+        auto const& event = events[replay_position_];
+        currently_pressed_keys_[event.scancode] = event.action;
+      }
+      replaying_ = ++replay_tick_ < replay_.length();
+    } else {
+      for (auto& event : pending_key_events_) {
+        currently_pressed_keys_[event.scancode] = event.action;
+        if (capturing_) {
+          event.tick = capture_tick_;
+          capture_.Add(event);
+        }
+      }
+      pending_key_events_.clear();
+      capture_tick_ += capturing_ ? 1 : 0;
+    }
+  }
+
   // after each event update we shall call each callback
   for (auto i = key_bind_callbacks_.begin(); i != key_bind_callbacks_.end();) {
     auto cpk_itr = currently_pressed_keys_.find(i->first);
@@ -73,6 +99,33 @@ void Input::Update(const uint64_t) {
   }
 }
 
+void Input::StartCapture() {
+  std::scoped_lock<std::mutex> lock(key_events_mutex_);
+  capturing_ = true;
+  capture_ = InputCapture();
+  capture_tick_ = 0;
+}
+
+InputCapture Input::StopCapture() {
+  std::scoped_lock<std::mutex> lock(key_events_mutex_);
+  capturing_ = false;
+  capture_.SetLength(capture_tick_);
+  return std::move(capture_);
+}
+
+void Input::StartReplay(InputCapture capture) {
+  std::scoped_lock<std::mutex> lock(key_events_mutex_);
+  replay_ = std::move(capture);
+  replay_position_ = 0;
+  replay_tick_ = 0;
+  replaying_ = replay_.length() != 0;
+}
+
+bool Input::replaying() {
+  std::scoped_lock<std::mutex> lock(key_events_mutex_);
+  return replaying_;
+}
+
 bool Input::AddKeyCallback(int32_t scancode,
                            std::shared_ptr<KeyBindCallback> kbc, bool rewrite) {
   if (key_bind_callbacks_.find(scancode) == key_bind_callbacks_.end() ||
@@ -95,7 +148,9 @@ void Input::KeyCallback(int32_t key, int32_t scancode, int32_t action,
     }
     break;
   }
-  currently_pressed_keys_[scancode] = action;
+  // applied by Update at the beginning of the next tick
+  std::scoped_lock<std::mutex> lock(key_events_mutex_);
+  pending_key_events_.push_back({0, key, scancode, action, mods});
 }
 void Input::CharCallback(uint32_t codepoint) {
   while (!char_callbacks_.empty()) {
@@ -12,6 +12,8 @@
 #include <thread>
 #include <vector>
 
+#include "InputCapture.h"
+
 namespace engine::client {
 // Functions from this class should be called only in the main thread.
 
@@ -25,6 +27,9 @@ namespace engine::client {
 /// the callback itself.
 ///
 /// Other callbacks in the stack won't be called.
+///
+/// Key states are changed by Update, so they change only at the beginning of
+/// a tick and can be captured and replayed tick by tick.
 /// </summary>
 class Input : public core::Ticker {
  public:
@@ -216,6 +221,28 @@ class Input : public core::Ticker {
   bool AddKeyCallback(int32_t scancode, std::shared_ptr<KeyBindCallback> kbc,
                       bool rewrite = false);
 
+  /// <summary>
+  /// Starts recording key events applied by Update. Tick 0 of the capture is
+  /// the next Update.
+  /// </summary>
+  void StartCapture();
+
+  /// <summary>
+  /// Stops recording.
+  /// </summary>
+  /// <returns>Key events recorded since StartCapture.</returns>
+  InputCapture StopCapture();
+
+  /// <summary>
+  /// Key events are taken from the capture instead of the window until the
+  /// capture ends. Tick 0 of the capture is the next Update. Works without a
+  /// window, so a capture can be replayed headlessly.
+  /// </summary>
+  /// <param name="capture">capture to replay</param>
+  void StartReplay(InputCapture capture);
+
+  [[nodiscard]] bool replaying();
+
  protected:
   Input() : Ticker(1U) {}
 
@@ -262,6 +289,19 @@ class Input : public core::Ticker {
   // scancode, action(currently pressed or were released)
   std::map<int32_t, int32_t> currently_pressed_keys_;
 
+  // Guards the key events and the capture state, callbacks are called in the
+  // main thread while Update is called by the Core.
+  std::mutex key_events_mutex_;
+  // key events which will be applied by the next Update
+  std::vector<InputCapture::KeyEvent> pending_key_events_;
+  bool capturing_ = false;
+  InputCapture capture_;
+  uint64_t capture_tick_ = 0;
+  bool replaying_ = false;
+  InputCapture replay_;
+  size_t replay_position_ = 0;
+  uint64_t replay_tick_ = 0;
+
   // scancode and function to call.
   std::map<int32_t, std::shared_ptr<KeyBindCallback>> key_bind_callbacks_;
 
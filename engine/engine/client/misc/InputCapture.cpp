@@ -0,0 +1,90 @@
+#include "InputCapture.h"
+
+#include <array>
+#include <utility>
+
+namespace engine::client {
+namespace {
+constexpr std::array<char, 4> kMagic = {'E', 'I', 'C', '1'};
+
+void WriteVarint(std::ostream& out, uint64_t value) {
+  while (value >= 0x80) {
+    out.put(char((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.put(char(value));
+}
+
+bool ReadVarint(std::istream& in, uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    const int byte = in.get();
+    if (byte == std::istream::traits_type::eof()) {
+      return false;
+    }
+    value |= uint64_t(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// small negative values, e.g. GLFW_KEY_UNKNOWN, stay small
+uint64_t ZigZag(int32_t value) {
+  return (uint32_t(value) << 1) ^ uint32_t(value >> 31);
+}
+int32_t UnZigZag(uint64_t value) {
+  return int32_t(uint32_t(value >> 1) ^ -uint32_t(value & 1));
+}
+}  // namespace
+
+void InputCapture::Save(std::ostream& out) const {
+  out.write(kMagic.data(), kMagic.size());
+  WriteVarint(out, events_.size());
+  WriteVarint(out, length_);
+  uint64_t tick = 0;
+  for (auto const& event : events_) {
+    WriteVarint(out, event.tick - tick);
+    tick = event.tick;
+    WriteVarint(out, ZigZag(event.key));
+    WriteVarint(out, ZigZag(event.scancode));
+    out.put(char(event.action));
+    out.put(char(event.mods));
+  }
+}
+
+bool InputCapture::Load(std::istream& in) {
+  events_.clear();
+  length_ = 0;
+  std::array<char, 4> magic{};
+  uint64_t count = 0;
+  uint64_t length = 0;
+  if (!in.read(magic.data(), magic.size()) || magic != kMagic ||
+      !ReadVarint(in, count) || !ReadVarint(in, length)) {
+    return false;
+  }
+  std::vector<KeyEvent> events;
+  uint64_t tick = 0;
+  for (uint64_t i = 0; i < count; i++) {
+    uint64_t delta = 0;
+    uint64_t key = 0;
+    uint64_t scancode = 0;
+    if (!ReadVarint(in, delta) || !ReadVarint(in, key) ||
+        !ReadVarint(in, scancode)) {
+      return false;
+    }
+    const int action = in.get();
+    const int mods = in.get();
+    if (mods == std::istream::traits_type::eof()) {
+      return false;
+    }
+    tick += delta;
+    events.push_back({tick, UnZigZag(key), UnZigZag(scancode),
+                      int32_t(uint8_t(action)), int32_t(uint8_t(mods))});
+  }
+  events_ = std::move(events);
+  length_ = length;
+  return true;
+}
+}  // namespace engine::client
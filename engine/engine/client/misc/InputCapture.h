@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace engine::client {
+/// <summary>
+/// Key events applied by Input::Update, tick by tick.
+/// Ticks are counted from the beginning of the capture, so a capture can be
+/// replayed at any moment, see Input::StartReplay.
+///
+/// Binary form: "EIC1", varint event count, varint length in ticks, then for
+/// every event varint tick delta from the previous event, zigzag varint key
+/// and scancode, one byte action and one byte mods. A key press takes about
+/// 5 bytes.
+/// </summary>
+class InputCapture {
+ public:
+  struct KeyEvent {
+    uint64_t tick;
+    int32_t key;
+    int32_t scancode;
+    int32_t action;
+    int32_t mods;
+  };
+
+  // Events should be added in the order of ticks.
+  void Add(KeyEvent const& event) { events_.push_back(event); }
+
+  [[nodiscard]] std::vector<KeyEvent> const& events() const noexcept {
+    return events_;
+  }
+
+  // Amount of captured ticks, including the ticks without events.
+  [[nodiscard]] uint64_t length() const noexcept { return length_; }
+  void SetLength(uint64_t length) noexcept { length_ = length; }
+
+  void Save(std::ostream& out) const;
+  // Returns false if the stream doesn't contain a capture, the capture is
+  // left empty in that case.
+  bool Load(std::istream& in);
+
+ private:
+  std::vector<KeyEvent> events_;
+  uint64_t length_ = 0;
+};
+}  // namespace engine::client
@@ -0,0 +1,57 @@
+#include "BackgroundWorkers.h"
+
+#include <utility>
+
+namespace engine::core {
+bool BackgroundWorkers::Submit(Job job) {
+  {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    if (stopped_) {
+      return false;
+    }
+    if (threads_.empty()) {
+      for (uint32_t i = 0; i < thread_count_; i++) {
+        threads_.emplace_back(&BackgroundWorkers::ThreadFunction, this);
+      }
+    }
+    jobs_.push_back(std::move(job));
+  }
+  wake_.notify_one();
+  return true;
+}
+
+void BackgroundWorkers::Stop() {
+  std::deque<Job> cancelled;
+  {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+    cancelled.swap(jobs_);
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+  for (auto& job : cancelled) {
+    job(true);
+  }
+}
+
+void BackgroundWorkers::ThreadFunction() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this]() { return stopped_ || !jobs_.empty(); });
+      if (stopped_) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    job(false);
+  }
+}
+}  // namespace engine::core
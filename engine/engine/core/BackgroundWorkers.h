@@ -0,0 +1,49 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace engine::core {
+/// <summary>
+/// Threads for work which doesn't belong to any tick, e.g. file IO of
+/// co_await Background(job). The threads are started by the first Submit,
+/// so a Core which doesn't use them doesn't pay for them.
+/// Jobs are called with cancelled == false when they run, or with
+/// cancelled == true by Stop if they haven't started yet, so their owner can
+/// release what they hold.
+/// </summary>
+class BackgroundWorkers {
+ public:
+  using Job = std::function<void(bool cancelled)>;
+
+  explicit BackgroundWorkers(uint32_t threads) noexcept
+      : thread_count_(threads == 0 ? 1 : threads) {}
+  ~BackgroundWorkers() { Stop(); }
+
+  /* Disable copy and move semantics. */
+  BackgroundWorkers(const BackgroundWorkers&) = delete;
+  BackgroundWorkers(BackgroundWorkers&&) = delete;
+  BackgroundWorkers& operator=(const BackgroundWorkers&) = delete;
+  BackgroundWorkers& operator=(BackgroundWorkers&&) = delete;
+
+  // Returns false if the workers are stopped, the job isn't called then.
+  bool Submit(Job job);
+
+  // Waits for the running jobs and cancels the rest.
+  void Stop();
+
+ private:
+  void ThreadFunction();
+
+  const uint32_t thread_count_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<Job> jobs_;
+  std::vector<std::thread> threads_;
+  bool stopped_ = false;
+};
+}  // namespace engine::core
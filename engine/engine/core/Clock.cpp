@@ -0,0 +1,125 @@
+#include "Clock.h"
+
+#include <mutex>
+#include <thread>
+
+#if defined(__GNUC__) && defined(ENGINE_CLOCK_HAS_TSC)
+#include <cpuid.h>
+#endif
+
+namespace engine::core {
+namespace {
+// shared by Init and SetSource, the source is chosen only once
+std::once_flag init_once;
+}  // namespace
+
+#if defined(ENGINE_CLOCK_HAS_TSC)
+bool Clock::HasInvariantTsc() noexcept {
+  // CPUID.80000007H:EDX[8] - TSC runs at a constant rate in all ACPI P-, C-
+  // and T-states
+#if defined(_MSC_VER)
+  int regs[4] = {0};
+  __cpuid(regs, 0x80000000);
+  if (uint32_t(regs[0]) < 0x80000007) {
+    return false;
+  }
+  __cpuid(regs, 0x80000007);
+  return (regs[3] & (1 << 8)) != 0;
+#else
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0) {
+    return false;
+  }
+  return (edx & (1U << 8)) != 0;
+#endif
+}
+#endif
+
+bool Clock::Supports(Source source) noexcept {
+  switch (source) {
+    case Source::kTsc:
+#if defined(ENGINE_CLOCK_HAS_TSC)
+      return HasInvariantTsc();
+#else
+      return false;
+#endif
+    case Source::kMonotonicRaw:
+#if defined(__linux__)
+      return true;
+#else
+      return false;
+#endif
+    default:
+      return true;
+  }
+}
+
+bool Clock::SetSource(Source source) {
+  if (!Supports(source)) {
+    return false;
+  }
+  bool initialized = false;
+  std::call_once(init_once, [source, &initialized]() {
+    steady_base_ = std::chrono::steady_clock::now();
+    initialized = Switch(source);
+    initialized_.store(true, std::memory_order_release);
+  });
+  return initialized;
+}
+
+bool Clock::Switch(Source source) {
+  if (!Supports(source)) {
+    return false;
+  }
+  const uint64_t current = Read();
+  switch (source) {
+#if defined(ENGINE_CLOCK_HAS_TSC)
+    case Source::kTsc: {
+      // calibrate the TSC frequency against steady_clock
+      using namespace std::chrono;
+      const auto steady_start = steady_clock::now();
+      const uint64_t tsc_start = ReadTsc();
+      std::this_thread::sleep_for(10ms);
+      const auto steady_end = steady_clock::now();
+      const uint64_t tsc_end = ReadTsc();
+      ns_per_tsc_tick_ =
+          double(duration_cast<nanoseconds>(steady_end - steady_start)
+                     .count()) /
+          double(tsc_end - tsc_start);
+      const uint64_t elapsed =
+          uint64_t(duration_cast<nanoseconds>(steady_end - steady_start)
+                       .count());
+      tsc_base_ =
+          tsc_end - uint64_t(double(current + elapsed) / ns_per_tsc_tick_);
+      break;
+    }
+#endif
+#if defined(__linux__)
+    case Source::kMonotonicRaw: {
+      timespec ts;
+      clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+      raw_base_ =
+          uint64_t(ts.tv_sec) * 1000000000ULL + uint64_t(ts.tv_nsec) - current;
+      break;
+    }
+#endif
+    default:
+      steady_base_ =
+          std::chrono::steady_clock::now() - std::chrono::nanoseconds(current);
+      break;
+  }
+  source_ = source;
+  return true;
+}
+
+void Clock::Init() noexcept {
+  std::call_once(init_once, []() {
+    // every timestamp of the engine counts from here
+    steady_base_ = std::chrono::steady_clock::now();
+    if (!Switch(Source::kTsc) && !Switch(Source::kMonotonicRaw)) {
+      Switch(Source::kSteadyClock);
+    }
+    initialized_.store(true, std::memory_order_release);
+  });
+}
+}  // namespace engine::core
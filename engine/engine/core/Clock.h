@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define ENGINE_CLOCK_HAS_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ENGINE_CLOCK_HAS_TSC
+#endif
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+namespace engine::core {
+/// <summary>
+/// Monotonic engine clock with nanosecond resolution.
+/// Time is counted from the moment the clock was initialized, so it fits
+/// into uint64_t and converts to double seconds without losing precision.
+///
+/// The source is selected on the first use, not during the static
+/// initialization, so binaries which never read the clock don't pay for the
+/// TSC calibration:
+/// kTsc is used if the processor has an invariant TSC, it is calibrated
+/// against steady_clock and costs a single rdtsc instruction.
+/// kMonotonicRaw is used on linux otherwise, it is not slewed by NTP.
+/// kSteadyClock is the portable fallback.
+/// </summary>
+class Clock {
+ public:
+  enum class Source { kSteadyClock, kMonotonicRaw, kTsc };
+
+  // Nanoseconds since the clock initialization.
+  [[nodiscard]] static uint64_t now_ns() noexcept {
+    if (!initialized_.load(std::memory_order_acquire)) [[unlikely]] {
+      Init();
+    }
+    return Read();
+  }
+
+  // Seconds since the clock initialization.
+  [[nodiscard]] static double now_seconds() noexcept {
+    return double(now_ns()) / 1e9;
+  }
+
+  [[nodiscard]] static Source source() noexcept {
+    if (!initialized_.load(std::memory_order_acquire)) [[unlikely]] {
+      Init();
+    }
+    return source_;
+  }
+
+  // Initializes the clock with the given source instead of the best one.
+  // Returns false if the source isn't supported or the clock is already
+  // initialized, the source can't change while other threads read the clock.
+  // Should be called before the Core is created.
+  static bool SetSource(Source source);
+
+  // Chooses the best source once, later calls return right away. Called by
+  // the first timestamp, can be called earlier so the calibration doesn't
+  // delay it.
+  static void Init() noexcept;
+
+ private:
+  [[nodiscard]] static uint64_t Read() noexcept {
+    switch (source_) {
+#if defined(ENGINE_CLOCK_HAS_TSC)
+      case Source::kTsc:
+        return uint64_t(double(ReadTsc() - tsc_base_) * ns_per_tsc_tick_);
+#endif
+#if defined(__linux__)
+      case Source::kMonotonicRaw: {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return uint64_t(ts.tv_sec) * 1000000000ULL + uint64_t(ts.tv_nsec) -
+               raw_base_;
+      }
+#endif
+      default:
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - steady_base_)
+                            .count());
+    }
+  }
+
+  // Calibrates the source and makes it current, only called while the clock
+  // is initialized.
+  static bool Switch(Source source);
+#if defined(ENGINE_CLOCK_HAS_TSC)
+  static uint64_t ReadTsc() noexcept { return __rdtsc(); }
+  static bool HasInvariantTsc() noexcept;
+#endif
+  static bool Supports(Source source) noexcept;
+
+  // set by Init once the source is chosen
+  static inline std::atomic<bool> initialized_ = false;
+  // constant initialized, Init sets the base
+  static inline Source source_ = Source::kSteadyClock;
+  static inline std::chrono::steady_clock::time_point steady_base_{};
+  static inline uint64_t raw_base_ = 0;
+  static inline uint64_t tsc_base_ = 0;
+  static inline double ns_per_tsc_tick_ = 0;
+};
+}  // namespace engine::core
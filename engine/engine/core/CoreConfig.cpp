@@ -0,0 +1,160 @@
+#include "CoreConfig.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <fstream>
+#include <utility>
+
+namespace engine::core {
+namespace {
+std::string_view Trim(std::string_view text) {
+  constexpr std::string_view kSpaces = " \t\r\n";
+  const size_t begin = text.find_first_not_of(kSpaces);
+  if (begin == std::string_view::npos) {
+    return {};
+  }
+  const size_t end = text.find_last_not_of(kSpaces);
+  return text.substr(begin, end - begin + 1);
+}
+
+bool ParseUint(std::string_view text, uint32_t& value) {
+  text = Trim(text);
+  auto [end, error] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  return error == std::errc() && end == text.data() + text.size() &&
+         !text.empty();
+}
+
+bool ParseBool(std::string_view text, bool& value) {
+  text = Trim(text);
+  if (text == "1" || text == "true" || text == "on") {
+    value = true;
+    return true;
+  }
+  if (text == "0" || text == "false" || text == "off") {
+    value = false;
+    return true;
+  }
+  return false;
+}
+}  // namespace
+
+bool CoreConfig::ParseCpuList(std::string_view text,
+                              std::vector<uint32_t>& cpus) {
+  // an upper bound, so a typo doesn't allocate gigabytes
+  constexpr uint32_t kMaxCpu = 4096;
+  std::vector<uint32_t> result;
+  text = Trim(text);
+  while (!text.empty()) {
+    const size_t comma = text.find(',');
+    const std::string_view item = text.substr(0, comma);
+    text = comma == std::string_view::npos ? std::string_view()
+                                           : text.substr(comma + 1);
+    const size_t dash = item.find('-');
+    uint32_t first = 0;
+    uint32_t last = 0;
+    if (!ParseUint(item.substr(0, dash), first)) {
+      return false;
+    }
+    last = first;
+    if (dash != std::string_view::npos &&
+        !ParseUint(item.substr(dash + 1), last)) {
+      return false;
+    }
+    if (last < first || last >= kMaxCpu) {
+      return false;
+    }
+    for (uint32_t cpu = first; cpu <= last; cpu++) {
+      result.push_back(cpu);
+    }
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  cpus = std::move(result);
+  return true;
+}
+
+bool CoreConfig::Set(std::string_view key, std::string_view value) {
+  key = Trim(key);
+  if (key == "threads") {
+    return ParseUint(value, threads);
+  }
+  if (key == "pin_threads") {
+    return ParseBool(value, pin_threads);
+  }
+  if (key == "reserved_cpus") {
+    return ParseCpuList(value, reserved_cpus);
+  }
+  if (key == "numa_local") {
+    return ParseBool(value, numa_local);
+  }
+  if (key == "manual_ticks") {
+    return ParseBool(value, manual_ticks);
+  }
+  if (key == "background_threads") {
+    uint32_t parsed = 0;
+    if (!ParseUint(value, parsed) || parsed == 0) {
+      return false;
+    }
+    background_threads = parsed;
+    return true;
+  }
+  if (key == "tickrate") {
+    uint32_t parsed = 0;
+    if (!ParseUint(value, parsed) || parsed == 0 || parsed > kMaxTickrate) {
+      return false;
+    }
+    tickrate = parsed;
+    return true;
+  }
+  return false;
+}
+
+bool CoreConfig::Valid() const noexcept {
+  return reserved_cpus.empty() || pin_threads || numa_local;
+}
+
+bool CoreConfig::LoadFile(std::string const& path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return false;
+  }
+  bool valid = true;
+  std::string line;
+  while (std::getline(file, line)) {
+    const std::string_view text = Trim(line);
+    if (text.empty() || text.front() == '#') {
+      continue;
+    }
+    const size_t equals = text.find('=');
+    if (equals == std::string_view::npos ||
+        !Set(text.substr(0, equals), text.substr(equals + 1))) {
+      valid = false;
+    }
+  }
+  return valid;
+}
+
+bool CoreConfig::LoadEnvironment() {
+  static constexpr std::pair<const char*, const char*> kVariables[] = {
+      {"ENGINE_THREADS", "threads"},
+      {"ENGINE_PIN_THREADS", "pin_threads"},
+      {"ENGINE_RESERVED_CPUS", "reserved_cpus"},
+      {"ENGINE_NUMA_LOCAL", "numa_local"},
+      {"ENGINE_TICKRATE", "tickrate"},
+      {"ENGINE_MANUAL_TICKS", "manual_ticks"},
+      {"ENGINE_BACKGROUND_THREADS", "background_threads"},
+  };
+  bool valid = true;
+  if (const char* path = std::getenv("ENGINE_CONFIG"); path != nullptr) {
+    valid = LoadFile(path);
+  }
+  for (auto const& [variable, key] : kVariables) {
+    if (const char* value = std::getenv(variable); value != nullptr) {
+      valid = Set(key, value) && valid;
+    }
+  }
+  return valid;
+}
+}  // namespace engine::core
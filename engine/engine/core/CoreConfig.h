@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace engine::core {
+/// <summary>
+/// Startup settings of the Core worker pool.
+///
+/// Settings are read from the code (Core::Configure), then from the config
+/// file named by ENGINE_CONFIG with key=value lines and then from the
+/// environment, every source overrides the previous one:
+///   threads        / ENGINE_THREADS        amount of update threads, 0 means
+///                                          one per CPU which isn't reserved
+///   pin_threads    / ENGINE_PIN_THREADS    pin every update thread to its CPU
+///   reserved_cpus  / ENGINE_RESERVED_CPUS  CPUs the update threads stay
+///                                          off, e.g. "0,1" or "0-3", needs
+///                                          pin_threads or numa_local
+///   numa_local     / ENGINE_NUMA_LOCAL     place update threads node by node
+///                                          and allocate their storage on the
+///                                          node of their CPU, implies pinning
+///   tickrate       / ENGINE_TICKRATE       ticks per second, can be changed
+///                                          later with Core::SetTickrate
+///   manual_ticks   / ENGINE_MANUAL_TICKS   the Core doesn't tick on its own,
+///                                          only in Core::RunTicks
+///   background_threads / ENGINE_BACKGROUND_THREADS  threads for
+///                                          co_await Background(job), they
+///                                          are started on the first use
+/// Booleans are 0/1, true/false, on/off.
+/// </summary>
+struct CoreConfig {
+  uint32_t threads = 0;
+  bool pin_threads = false;
+  std::vector<uint32_t> reserved_cpus;
+  bool numa_local = false;
+  uint32_t tickrate = kDefaultTickrate;
+  bool manual_ticks = false;
+  uint32_t background_threads = 1;
+
+  static constexpr uint32_t kDefaultTickrate = 64;
+  static constexpr uint32_t kMaxTickrate = 10000;
+
+  // Applies a single setting, the key is the one of the config file.
+  // Returns false if the key is unknown or the value is invalid, the config
+  // isn't changed then.
+  bool Set(std::string_view key, std::string_view value);
+
+  // Applies key=value lines, empty lines and lines starting with # are
+  // skipped. Returns false if the file can't be read or a line is invalid,
+  // valid lines are applied anyway.
+  bool LoadFile(std::string const& path);
+
+  // Applies the file named by ENGINE_CONFIG and then ENGINE_* variables
+  // which are set. Returns false if one of them is invalid.
+  bool LoadEnvironment();
+
+  // Returns false if the settings contradict each other: only pinned update
+  // threads stay off the reserved CPUs.
+  [[nodiscard]] bool Valid() const noexcept;
+
+  // Parses "0,2,4-7". Returns false on invalid input.
+  static bool ParseCpuList(std::string_view text, std::vector<uint32_t>& cpus);
+};
+}  // namespace engine::core
@@ -0,0 +1,116 @@
+#include "CpuTopology.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+
+#include <filesystem>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#endif
+
+namespace engine::core {
+uint32_t CpuTopology::cpu_count() noexcept {
+  return std::max(1U, std::thread::hardware_concurrency());
+}
+
+uint32_t CpuTopology::numa_node(uint32_t cpu) {
+#if defined(__linux__)
+  // the cpu directory contains a nodeN link
+  std::error_code error;
+  const std::filesystem::path path =
+      "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+  for (auto const& entry :
+       std::filesystem::directory_iterator(path, error)) {
+    const std::string name = entry.path().filename().string();
+    if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+        std::all_of(name.begin() + 4, name.end(),
+                    [](char c) { return c >= '0' && c <= '9'; })) {
+      return uint32_t(std::stoul(name.substr(4)));
+    }
+  }
+  return 0;
+#elif defined(_WIN32)
+  UCHAR node = 0;
+  if (cpu < 64 && GetNumaProcessorNode(UCHAR(cpu), &node) && node != 0xFF) {
+    return node;
+  }
+  return 0;
+#else
+  return 0;
+#endif
+}
+
+std::vector<uint32_t> CpuTopology::current_affinity() {
+  std::vector<uint32_t> cpus;
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+    for (uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+    return cpus;
+  }
+#elif defined(_WIN32)
+  // there is no getter, the setter returns the previous mask
+  const HANDLE thread = GetCurrentThread();
+  DWORD_PTR process_mask = 0;
+  DWORD_PTR system_mask = 0;
+  if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask,
+                             &system_mask)) {
+    const DWORD_PTR mask = SetThreadAffinityMask(thread, process_mask);
+    if (mask != 0) {
+      SetThreadAffinityMask(thread, mask);
+      for (uint32_t cpu = 0; cpu < 64; cpu++) {
+        if ((mask >> cpu) & 1) {
+          cpus.push_back(cpu);
+        }
+      }
+      return cpus;
+    }
+  }
+#endif
+  for (uint32_t cpu = 0; cpu < cpu_count(); cpu++) {
+    cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+bool CpuTopology::PinCurrentThread(std::span<const uint32_t> cpus) {
+  if (cpus.empty()) {
+    return false;
+  }
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (uint32_t cpu : cpus) {
+    if (cpu >= CPU_SETSIZE) {
+      return false;
+    }
+    CPU_SET(cpu, &set);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+  DWORD_PTR mask = 0;
+  for (uint32_t cpu : cpus) {
+    if (cpu >= 64) {
+      return false;
+    }
+    mask |= DWORD_PTR(1) << cpu;
+  }
+  return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+  return false;
+#endif
+}
+}  // namespace engine::core
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace engine::core {
+/// <summary>
+/// CPUs of the machine, their NUMA nodes and the affinity of threads.
+/// Implemented for linux and windows (up to 64 CPUs), on other platforms
+/// every CPU is on node 0 and the affinity can't be changed.
+/// </summary>
+class CpuTopology {
+ public:
+  [[nodiscard]] static uint32_t cpu_count() noexcept;
+
+  // NUMA node of the CPU, 0 if unknown.
+  [[nodiscard]] static uint32_t numa_node(uint32_t cpu);
+
+  // CPUs the calling thread is allowed to run on.
+  [[nodiscard]] static std::vector<uint32_t> current_affinity();
+
+  // Restricts the calling thread to the given CPUs. Returns false if the
+  // affinity can't be changed, e.g. the CPUs don't exist.
+  static bool PinCurrentThread(std::span<const uint32_t> cpus);
+};
+}  // namespace engine::core
@@ -0,0 +1,45 @@
+#include "FixedStep.h"
+
+#include <algorithm>
+
+namespace engine::core {
+namespace {
+uint64_t StepNs(double rate) noexcept {
+  return std::max<uint64_t>(uint64_t(1e9 / std::max(rate, 1e-3)), 1);
+}
+}  // namespace
+
+FixedStep::FixedStep(double rate, uint32_t max_substeps)
+    : step_ns_(StepNs(rate)), max_substeps_(std::max(max_substeps, 1U)) {}
+
+uint32_t FixedStep::Advance(uint64_t delta_ns, uint64_t now_ns) noexcept {
+  const uint64_t step = step_ns();
+  uint64_t accumulator =
+      accumulator_ns_.load(std::memory_order_relaxed) + delta_ns;
+  uint64_t count = accumulator / step;
+  if (count > max_substeps_) {
+    const uint64_t dropped = (count - max_substeps_) * step;
+    dropped_ns_.store(dropped_ns() + dropped, std::memory_order_relaxed);
+    accumulator -= dropped;
+    count = max_substeps_;
+  }
+  accumulator -= count * step;
+  accumulator_ns_.store(accumulator, std::memory_order_relaxed);
+  last_advance_ns_.store(now_ns, std::memory_order_relaxed);
+  steps_.store(steps() + count, std::memory_order_relaxed);
+  return uint32_t(count);
+}
+
+void FixedStep::SetRate(double rate) noexcept {
+  step_ns_.store(StepNs(rate), std::memory_order_relaxed);
+}
+
+double FixedStep::alpha(uint64_t now_ns) const noexcept {
+  const uint64_t last = last_advance_ns_.load(std::memory_order_relaxed);
+  // the time since the last Advance is not accumulated yet
+  const uint64_t elapsed =
+      accumulator_ns_.load(std::memory_order_relaxed) +
+      (now_ns > last ? now_ns - last : 0);
+  return std::min(double(elapsed) / double(step_ns()), 1.0);
+}
+}  // namespace engine::core
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace engine::core {
+/// <summary>
+/// Fixed-step accumulator of a system which should run at its own rate,
+/// independent of the Core tickrate, e.g. 128 Hz physics on a 64 Hz Core.
+/// The owner feeds it with the tick duration and runs as many steps as it
+/// returns:
+///
+///   for (uint32_t i = physics_.Advance(Core::tick_delta_ns(),
+///                                      Core::tick_time_ns());
+///        i > 0; i--) {
+///     Step(physics_.step_seconds());
+///   }
+///
+/// At most max_substeps steps are run per Advance, the rest of the time is
+/// dropped, so a long tick doesn't make the next ones even longer.
+/// The time which doesn't add up to a whole step is carried over, alpha()
+/// tells how far the system is between its last two steps, so the renderer
+/// can interpolate their states.
+///
+/// Advance and SetRate should be called by one thread at a time, alpha and
+/// the getters can be called from any thread.
+/// </summary>
+class FixedStep {
+ public:
+  static constexpr uint32_t kDefaultMaxSubsteps = 8;
+
+  // rate is in steps per second and should be positive.
+  explicit FixedStep(double rate, uint32_t max_substeps = kDefaultMaxSubsteps);
+
+  /* Disable copy and move semantics. */
+  FixedStep(const FixedStep&) = delete;
+  FixedStep(FixedStep&&) = delete;
+  FixedStep& operator=(const FixedStep&) = delete;
+  FixedStep& operator=(FixedStep&&) = delete;
+
+  /// <summary>
+  /// Accumulates the elapsed time.
+  /// </summary>
+  /// <param name="delta_ns">time since the previous call</param>
+  /// <param name="now_ns">timestamp the delta ends at, see Clock</param>
+  /// <returns>amount of steps which should be run now</returns>
+  uint32_t Advance(uint64_t delta_ns, uint64_t now_ns) noexcept;
+
+  // Takes effect from the next Advance, the accumulated time is kept.
+  void SetRate(double rate) noexcept;
+
+  // Position between the last two steps at the given time, from 0 to 1.
+  [[nodiscard]] double alpha(uint64_t now_ns) const noexcept;
+
+  [[nodiscard]] uint64_t step_ns() const noexcept {
+    return step_ns_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] double step_seconds() const noexcept {
+    return double(step_ns()) / 1e9;
+  }
+  [[nodiscard]] uint32_t max_substeps() const noexcept {
+    return max_substeps_;
+  }
+  // Steps which were run since the creation.
+  [[nodiscard]] uint64_t steps() const noexcept {
+    return steps_.load(std::memory_order_relaxed);
+  }
+  // Time which was dropped because of max_substeps.
+  [[nodiscard]] uint64_t dropped_ns() const noexcept {
+    return dropped_ns_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<uint64_t> step_ns_;
+  const uint32_t max_substeps_;
+  // time which doesn't add up to a whole step, as of last_advance_ns_
+  std::atomic<uint64_t> accumulator_ns_ = 0;
+  std::atomic<uint64_t> last_advance_ns_ = 0;
+  std::atomic<uint64_t> steps_ = 0;
+  std::atomic<uint64_t> dropped_ns_ = 0;
+};
+}  // namespace engine::core
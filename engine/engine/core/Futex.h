@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#if defined(_WIN32)
+// min and max macros would break std::min and std::max in the files which
+// include Core.h
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace engine::core::futex {
+// Blocks the calling thread while word is equal to expected.
+// Can return spuriously, so the caller should check the value again.
+inline void Wait(std::atomic<uint32_t>& word, uint32_t expected) noexcept {
+#if defined(_WIN32)
+  WaitOnAddress(&word, &expected, sizeof(expected), INFINITE);
+#elif defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE,
+          expected, nullptr, nullptr, 0);
+#else
+  if (word.load(std::memory_order_relaxed) == expected) {
+    std::this_thread::yield();
+  }
+#endif
+}
+
+// Wakes every thread blocked in Wait on this word.
+inline void WakeAll(std::atomic<uint32_t>& word) noexcept {
+#if defined(_WIN32)
+  WakeByAddressAll(&word);
+#elif defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE,
+          INT32_MAX, nullptr, nullptr, 0);
+#else
+  (void)word;
+#endif
+}
+
+// Hint for the processor that we are in a spin loop.
+inline void CpuRelax() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  YieldProcessor();
+#elif defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+}  // namespace engine::core::futex
@@ -0,0 +1,127 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace engine::core {
+void LatencyStats::WriteJson(std::ostream& out) const {
+  out << "{\"count\":" << count << ",\"mean_ns\":" << uint64_t(mean_ns)
+      << ",\"p50_ns\":" << p50_ns << ",\"p99_ns\":" << p99_ns
+      << ",\"p999_ns\":" << p999_ns << ",\"max_ns\":" << max_ns << "}";
+}
+
+size_t LatencyHistogram::BucketIndex(uint64_t value_ns) noexcept {
+  if (value_ns < kSubBuckets) {
+    return size_t(value_ns);
+  }
+  // value = mantissa << shift, where mantissa is in [kSubBuckets,
+  // 2 * kSubBuckets)
+  const size_t exponent = size_t(std::bit_width(value_ns)) - 1;
+  if (exponent > kMaxExponent) {
+    return kBuckets - 1;
+  }
+  const size_t shift = exponent - kSubBucketBits;
+  const size_t mantissa = size_t(value_ns >> shift);
+  return (shift + 1) * kSubBuckets + (mantissa - kSubBuckets);
+}
+
+uint64_t LatencyHistogram::BucketValue(size_t index) noexcept {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  const size_t shift = index / kSubBuckets - 1;
+  const uint64_t mantissa = kSubBuckets + index % kSubBuckets;
+  const uint64_t lower = mantissa << shift;
+  return lower + ((uint64_t(1) << shift) >> 1);
+}
+
+void LatencyHistogram::Rotate(uint64_t now_ns) noexcept {
+  const uint32_t next = current_.load(std::memory_order_relaxed) ^ 1U;
+  for (auto& count : counts_[next]) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  WindowSummary& summary = summaries_[next];
+  summary.count.store(0, std::memory_order_relaxed);
+  summary.sum_ns.store(0, std::memory_order_relaxed);
+  summary.max_ns.store(0, std::memory_order_relaxed);
+  current_.store(next, std::memory_order_release);
+  window_start_ns_ = now_ns;
+}
+
+void LatencyHistogram::Record(uint64_t value_ns, uint64_t now_ns) noexcept {
+  // single writer, so plain loads and stores are enough, no read-modify-write
+  uint32_t current = current_.load(std::memory_order_relaxed);
+  if (now_ns - window_start_ns_ >= kWindowNs ||
+      summaries_[current].count.load(std::memory_order_relaxed) >=
+          kMaxWindowSamples) {
+    Rotate(now_ns);
+    current ^= 1U;
+  }
+  WindowSummary& summary = summaries_[current];
+  auto& bucket = counts_[current][BucketIndex(value_ns)];
+  bucket.store(uint16_t(bucket.load(std::memory_order_relaxed) + 1),
+               std::memory_order_relaxed);
+  summary.count.store(summary.count.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+  summary.sum_ns.store(
+      summary.sum_ns.load(std::memory_order_relaxed) + value_ns,
+      std::memory_order_relaxed);
+  if (value_ns > summary.max_ns.load(std::memory_order_relaxed)) {
+    summary.max_ns.store(value_ns, std::memory_order_relaxed);
+  }
+
+  total_count_.store(total_count_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+  if (value_ns > max_ns_.load(std::memory_order_relaxed)) {
+    max_ns_.store(value_ns, std::memory_order_relaxed);
+  }
+}
+
+double LatencyHistogram::mean_ns() const noexcept {
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  for (auto const& summary : summaries_) {
+    count += summary.count.load(std::memory_order_relaxed);
+    sum += summary.sum_ns.load(std::memory_order_relaxed);
+  }
+  return count == 0 ? 0.0 : double(sum) / double(count);
+}
+
+uint64_t LatencyHistogram::window_max_ns() const noexcept {
+  return std::max(summaries_[0].max_ns.load(std::memory_order_relaxed),
+                  summaries_[1].max_ns.load(std::memory_order_relaxed));
+}
+
+LatencyStats LatencyHistogram::stats() const noexcept {
+  std::array<uint32_t, kBuckets> counts;
+  uint64_t total = 0;
+  for (size_t i = 0; i < kBuckets; i++) {
+    counts[i] = uint32_t(counts_[0][i].load(std::memory_order_relaxed)) +
+                counts_[1][i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+
+  LatencyStats stats;
+  stats.count = total;
+  stats.mean_ns = mean_ns();
+  stats.max_ns = window_max_ns();
+  if (total == 0) {
+    return stats;
+  }
+  // the smallest value which is greater or equal to q of the samples
+  auto rank = [total](double q) {
+    return std::max<uint64_t>(uint64_t(q * double(total) + 0.999999), 1);
+  };
+  const uint64_t ranks[] = {rank(0.5), rank(0.99), rank(0.999)};
+  uint64_t* results[] = {&stats.p50_ns, &stats.p99_ns, &stats.p999_ns};
+  size_t next = 0;
+  uint64_t accumulated = 0;
+  for (size_t i = 0; i < kBuckets && next < std::size(ranks); i++) {
+    accumulated += counts[i];
+    while (next < std::size(ranks) && accumulated >= ranks[next]) {
+      *results[next++] = std::min(BucketValue(i), stats.max_ns);
+    }
+  }
+  return stats;
+}
+}  // namespace engine::core
@@ -0,0 +1,92 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+namespace engine::core {
+struct LatencyStats {
+  uint64_t count = 0;
+  uint64_t p50_ns = 0;
+  uint64_t p99_ns = 0;
+  uint64_t p999_ns = 0;
+  uint64_t max_ns = 0;
+  double mean_ns = 0;
+
+  // Writes {"count":..,"mean_ns":..,"p50_ns":..,...}
+  void WriteJson(std::ostream& out) const;
+};
+
+/// <summary>
+/// HDR-style histogram of durations over a sliding window.
+/// Values below 2^kSubBucketBits nanoseconds are counted exactly, larger ones
+/// go to one of 2^kSubBucketBits linear sub-buckets of their power of two, so
+/// the relative error of a percentile is at most 1 / 2^(kSubBucketBits + 1).
+///
+/// Samples are recorded into the current window, which is swapped with the
+/// previous one every kWindowNs (or when it is full), so the statistics cover
+/// the last one to two windows. A full window holds kMaxWindowSamples, so a
+/// fast ticker keeps at least 8192 samples and p999 rests on about 8 of
+/// them, slower tickers record fewer samples per second and p999 of less
+/// than 1000 samples is the maximum. Counters are 16 bit to keep the
+/// histogram about 1 KB, since every ticker has one.
+///
+/// Written by one thread at a time, can be read from any thread. Readers may
+/// see a window which is being cleared, so statistics are approximate.
+/// </summary>
+class LatencyHistogram {
+ public:
+  static constexpr size_t kSubBucketBits = 3;
+  static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+  // values up to 2^(kMaxExponent + 1) ns, about 8.6 seconds, larger ones are
+  // counted in the last bucket
+  static constexpr size_t kMaxExponent = 32;
+  static constexpr size_t kBuckets =
+      (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+  static constexpr uint64_t kWindowNs = 1000000000;
+  static constexpr uint32_t kMaxWindowSamples = 8192;
+  static_assert(kMaxWindowSamples <= UINT16_MAX, "counters are 16 bit");
+
+  // now_ns is the current Clock::now_ns(), it drives the window rotation.
+  void Record(uint64_t value_ns, uint64_t now_ns) noexcept;
+
+  // Percentiles over the previous and the current window.
+  [[nodiscard]] LatencyStats stats() const noexcept;
+
+  // Mean over the previous and the current window, O(1).
+  [[nodiscard]] double mean_ns() const noexcept;
+  // Maximum over the previous and the current window, O(1).
+  [[nodiscard]] uint64_t window_max_ns() const noexcept;
+
+  // Over the whole lifetime
+  [[nodiscard]] uint64_t total_count() const noexcept {
+    return total_count_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] uint64_t max_ns() const noexcept {
+    return max_ns_.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] static size_t BucketIndex(uint64_t value_ns) noexcept;
+  // Middle of the bucket
+  [[nodiscard]] static uint64_t BucketValue(size_t index) noexcept;
+
+ private:
+  // Summary of a window, kept apart from the counters, so recording touches
+  // the header and a single counter cache line.
+  struct WindowSummary {
+    std::atomic<uint32_t> count = 0;
+    std::atomic<uint64_t> sum_ns = 0;
+    std::atomic<uint64_t> max_ns = 0;
+  };
+
+  void Rotate(uint64_t now_ns) noexcept;
+
+  std::atomic<uint32_t> current_ = 0;
+  // used only by the writer
+  uint64_t window_start_ns_ = 0;
+  std::atomic<uint64_t> total_count_ = 0;
+  std::atomic<uint64_t> max_ns_ = 0;
+  std::array<WindowSummary, 2> summaries_;
+  std::array<std::array<std::atomic<uint16_t>, kBuckets>, 2> counts_{};
+};
+}  // namespace engine::core
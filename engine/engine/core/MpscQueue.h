@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace engine::core {
+/// <summary>
+/// Bounded lock-free multi-producer single-consumer queue.
+/// Every cell has a sequence number which tells whether the cell is free for
+/// the producer with the given position or is ready for the consumer, so
+/// producers only race for the enqueue position and never block each other.
+/// </summary>
+template <typename T, size_t kCapacity>
+class MpscQueue {
+  static_assert(kCapacity >= 2 && (kCapacity & (kCapacity - 1)) == 0,
+                "kCapacity should be a power of two");
+
+ public:
+  MpscQueue() : cells_(std::make_unique<Cell[]>(kCapacity)) {
+    for (size_t i = 0; i < kCapacity; i++) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  ~MpscQueue() {
+    T value;
+    while (TryPop(value)) {
+    }
+  }
+
+  /* Disable copy and move semantics. */
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue(MpscQueue&&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+  MpscQueue& operator=(MpscQueue&&) = delete;
+
+  // Can be called from any thread.
+  // Returns false if the queue is full, the value is left untouched.
+  bool TryPush(T&& value) {
+    size_t position = enqueue_position_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[position & kMask];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      auto difference = intptr_t(sequence) - intptr_t(position);
+      if (difference == 0) {
+        if (enqueue_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {  // the consumer hasn't freed the cell yet
+        return false;
+      } else {  // another producer took this position
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      }
+    }
+    new (&cell->storage) T(std::move(value));
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPush(T const& value) {
+    T copy = value;
+    return TryPush(std::move(copy));
+  }
+
+  // Should be called only by the consumer thread.
+  bool TryPop(T& out) {
+    Cell& cell = cells_[dequeue_position_ & kMask];
+    size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if (sequence != dequeue_position_ + 1) {
+      return false;
+    }
+    T* value = std::launder(reinterpret_cast<T*>(&cell.storage));
+    out = std::move(*value);
+    value->~T();
+    cell.sequence.store(dequeue_position_ + kCapacity,
+                        std::memory_order_release);
+    dequeue_position_ += 1;
+    return true;
+  }
+
+  // Should be called only by the consumer thread.
+  // Calls function for every value currently in the queue, returns the amount
+  // of values.
+  template <typename Function>
+  size_t Drain(Function&& function) {
+    size_t count = 0;
+    T value;
+    while (TryPop(value)) {
+      function(std::move(value));
+      count++;
+    }
+    return count;
+  }
+
+  [[nodiscard]] static constexpr size_t capacity() noexcept {
+    return kCapacity;
+  }
+
+ private:
+  static constexpr size_t kMask = kCapacity - 1;
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  alignas(64) std::atomic<size_t> enqueue_position_ = 0;
+  alignas(64) size_t dequeue_position_ = 0;
+};
+}  // namespace engine::core
@@ -0,0 +1,117 @@
+#include "RenderSnapshots.h"
+
+#include <algorithm>
+
+#include "TransformKernel.h"
+
+namespace engine::core {
+RenderSnapshots& RenderSnapshots::Global() {
+  static RenderSnapshots snapshots(TransformStore::Global(),
+                                   TransformHierarchy::Global());
+  return snapshots;
+}
+
+uint32_t RenderSnapshots::Add(TransformHandle transform) {
+  std::scoped_lock<std::mutex> lock(mutex_);
+  uint32_t id = 0;
+  if (!free_ids_.empty()) {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+  } else {
+    id = id_count_.load(std::memory_order_relaxed);
+    if (id == kPageSize * kMaxPages) {
+      return kNone;
+    }
+    if (id % kPageSize == 0) {
+      pages_[id / kPageSize] = std::make_unique<Page>();
+    }
+  }
+  Page& p = page(id);
+  p.transform[id % kPageSize].store(transform, std::memory_order_relaxed);
+  p.node[id % kPageSize].store({}, std::memory_order_relaxed);
+  if (id == id_count_.load(std::memory_order_relaxed)) {
+    id_count_.store(id + 1, std::memory_order_release);
+  }
+  return id;
+}
+
+void RenderSnapshots::SetNode(uint32_t id, NodeHandle node) noexcept {
+  if (id != kNone) {
+    page(id).node[id % kPageSize].store(node, std::memory_order_relaxed);
+  }
+}
+
+void RenderSnapshots::Remove(uint32_t id) {
+  if (id == kNone) {
+    return;
+  }
+  std::scoped_lock<std::mutex> lock(mutex_);
+  Page& p = page(id);
+  p.transform[id % kPageSize].store({}, std::memory_order_relaxed);
+  p.node[id % kPageSize].store({}, std::memory_order_relaxed);
+  free_ids_.push_back(id);
+}
+
+size_t RenderSnapshots::BeginCapture(const uint64_t tick,
+                                     const uint64_t tick_time_ns) {
+  RenderSnapshot& snapshot = buffer_.back();
+  snapshot.tick = tick;
+  snapshot.tick_time_ns = tick_time_ns;
+  // the buffer is reused, so it reallocates only when renderables are added
+  snapshot.world_matrices.resize(id_count_.load(std::memory_order_acquire));
+  return snapshot.world_matrices.size();
+}
+
+void RenderSnapshots::CaptureRange(const size_t begin,
+                                   const size_t end) noexcept {
+  glm::mat4* world = buffer_.back().world_matrices.data();
+  float components[10][kBlockSize];
+  for (size_t block = begin; block < end; block += kBlockSize) {
+    const size_t count = std::min<size_t>(kBlockSize, end - block);
+    for (size_t i = 0; i < count; i++) {
+      const auto id = uint32_t(block + i);
+      const TransformHandle handle =
+          page(id).transform[id % kPageSize].load(std::memory_order_relaxed);
+      // free ids get the identity
+      glm::vec3 position(0.0F);
+      glm::quat rotation(1.0F, 0.0F, 0.0F, 0.0F);
+      glm::vec3 scale(1.0F);
+      if (handle.valid()) {
+        position = store_.position(handle);
+        rotation = store_.rotation(handle);
+        scale = store_.scale(handle);
+      }
+      components[0][i] = position.x;
+      components[1][i] = position.y;
+      components[2][i] = position.z;
+      components[3][i] = rotation.x;
+      components[4][i] = rotation.y;
+      components[5][i] = rotation.z;
+      components[6][i] = rotation.w;
+      components[7][i] = scale.x;
+      components[8][i] = scale.y;
+      components[9][i] = scale.z;
+    }
+    TransformKernel::Compose(
+        {components[0], components[1], components[2], components[3],
+         components[4], components[5], components[6], components[7],
+         components[8], components[9]},
+        count, world + block);
+    // renderables with a parent or children use the propagated matrix
+    for (size_t i = 0; i < count; i++) {
+      const auto id = uint32_t(block + i);
+      const NodeHandle node =
+          page(id).node[id % kPageSize].load(std::memory_order_relaxed);
+      if (node.valid()) {
+        world[block + i] = hierarchy_.world_matrix(node);
+      }
+    }
+  }
+}
+
+void RenderSnapshots::Capture(const uint64_t tick,
+                              const uint64_t tick_time_ns) {
+  CaptureRange(0, BeginCapture(tick, tick_time_ns));
+  Publish();
+}
+}  // namespace engine::core
@@ -0,0 +1,124 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "TransformHierarchy.h"
+#include "TransformStore.h"
+#include "TripleBuffer.h"
+
+namespace engine::core {
+// State of the renderables at the end of one tick.
+struct RenderSnapshot {
+  // tick whose state is captured, 0 until the first snapshot
+  uint64_t tick = 0;
+  // Core::tick_time_ns() of that tick
+  uint64_t tick_time_ns = 0;
+  // indexed by the id of the renderable, identity for free ids
+  std::vector<glm::mat4> world_matrices;
+
+  // Identity for ids which weren't captured yet.
+  [[nodiscard]] glm::mat4 world_matrix(uint32_t id) const noexcept {
+    return id < world_matrices.size() ? world_matrices[id] : glm::mat4(1.0F);
+  }
+};
+
+/// <summary>
+/// Hands the transforms of the renderables from the simulation to the render
+/// thread without locks. Once per tick, after the transforms have moved and
+/// the hierarchy has been propagated, the world matrices are captured into
+/// the back buffer of a TripleBuffer and published, see SnapshotTicker. The
+/// render thread acquires the latest snapshot at the beginning of a frame
+/// and reads only it, so it never sees a half moved scene and neither side
+/// waits for the other.
+///
+/// Add, SetNode and Remove can be called from any thread, transforms and
+/// nodes shouldn't be removed during the capture. Capturing costs the amount
+/// of renderables, not of the TransformStore.
+/// </summary>
+class RenderSnapshots {
+ public:
+  static constexpr uint32_t kPageSize = 1024;
+  static constexpr uint32_t kMaxPages = 4096;
+  // Invalid id, returned if there are too many renderables.
+  static constexpr uint32_t kNone = UINT32_MAX;
+
+  RenderSnapshots(TransformStore& store, TransformHierarchy& hierarchy)
+      : store_(store), hierarchy_(hierarchy) {}
+  ~RenderSnapshots() = default;
+
+  /* Disable copy and move semantics. */
+  RenderSnapshots(const RenderSnapshots&) = delete;
+  RenderSnapshots(RenderSnapshots&&) = delete;
+  RenderSnapshots& operator=(const RenderSnapshots&) = delete;
+  RenderSnapshots& operator=(RenderSnapshots&&) = delete;
+
+  // Snapshots of engine::core::Object, over TransformStore::Global() and
+  // TransformHierarchy::Global().
+  [[nodiscard]] static RenderSnapshots& Global();
+
+  // Returns the id of the renderable in the snapshots, ids of removed
+  // renderables are reused.
+  uint32_t Add(TransformHandle transform);
+  // The world matrix of the node is captured instead of the model matrix of
+  // the transform, an invalid node switches back.
+  void SetNode(uint32_t id, NodeHandle node) noexcept;
+  void Remove(uint32_t id);
+
+  // Simulation side, called by one thread at a time.
+  // Starts a snapshot in the back buffer, returns the amount of ids for
+  // CaptureRange.
+  size_t BeginCapture(uint64_t tick, uint64_t tick_time_ns);
+  // Captures ids [begin, end). Can be called concurrently for disjoint
+  // ranges.
+  void CaptureRange(size_t begin, size_t end) noexcept;
+  // Publishes the back buffer once every range has been captured.
+  void Publish() noexcept { buffer_.Publish(); }
+  // All of the above in the calling thread.
+  void Capture(uint64_t tick, uint64_t tick_time_ns);
+
+  // Render side, called by one thread.
+  // Takes the latest published snapshot, the previous one if nothing new was
+  // published. It stays valid until the next Acquire.
+  RenderSnapshot const& Acquire() noexcept {
+    buffer_.Acquire();
+    return buffer_.front();
+  }
+  // Snapshot taken by the last Acquire.
+  [[nodiscard]] RenderSnapshot const& front() const noexcept {
+    return buffer_.front();
+  }
+
+ private:
+  // renderables whose model matrices are composed at once
+  static constexpr uint32_t kBlockSize = 64;
+
+  struct Page {
+    // invalid for free ids
+    std::array<std::atomic<TransformHandle>, kPageSize> transform{};
+    std::array<std::atomic<NodeHandle>, kPageSize> node{};
+  };
+
+  [[nodiscard]] Page& page(uint32_t id) const noexcept {
+    return *pages_[id / kPageSize];
+  }
+
+  TransformStore& store_;
+  TransformHierarchy& hierarchy_;
+
+  std::array<std::unique_ptr<Page>, kMaxPages> pages_;
+  // ids below it have a page
+  std::atomic<uint32_t> id_count_ = 0;
+
+  // guards the ids
+  std::mutex mutex_;
+  std::vector<uint32_t> free_ids_;
+
+  TripleBuffer<RenderSnapshot> buffer_;
+};
+}  // namespace engine::core
@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "Futex.h"
+
+namespace engine::core {
+/// <summary>
+/// Sense-reversing barrier for a fixed amount of threads.
+/// Threads spin for a short period and then sleep on a futex, so a barrier
+/// round costs one atomic increment per thread and a single wake syscall,
+/// which is issued only if somebody actually went to sleep.
+/// The last thread to arrive runs the completion function before releasing
+/// the others, so the completion can safely touch state shared by the whole
+/// tick.
+/// </summary>
+class TickBarrier {
+ public:
+  // Amount of spin iterations before the thread goes to sleep
+  static constexpr uint32_t kDefaultSpinCount = 4096;
+
+  // If there are more threads than cores, spinning only steals time from the
+  // threads we are waiting for, so we go to sleep right away.
+  explicit TickBarrier(uint32_t count)
+      : TickBarrier(count, count <= std::thread::hardware_concurrency()
+                               ? kDefaultSpinCount
+                               : 0) {}
+
+  TickBarrier(uint32_t count, uint32_t spin_count) noexcept
+      : count_(count), spin_count_(spin_count) {}
+
+  /* Disable copy and move semantics. */
+  TickBarrier(const TickBarrier&) = delete;
+  TickBarrier(TickBarrier&&) = delete;
+  TickBarrier& operator=(const TickBarrier&) = delete;
+  TickBarrier& operator=(TickBarrier&&) = delete;
+
+  template <typename Completion>
+  void ArriveAndWait(Completion&& on_completion) {
+    const uint32_t sense = sense_.load(std::memory_order_acquire);
+    if (arrived_.fetch_add(1, std::memory_order_acq_rel) + 1 == count_) {
+      on_completion();
+      arrived_.store(0, std::memory_order_relaxed);
+      sense_.store(sense + 1, std::memory_order_seq_cst);
+      if (sleepers_.load(std::memory_order_seq_cst) != 0) {
+        futex::WakeAll(sense_);
+      }
+      return;
+    }
+
+    for (uint32_t i = 0; i < spin_count_; i++) {
+      if (sense_.load(std::memory_order_acquire) != sense) {
+        return;
+      }
+      futex::CpuRelax();
+    }
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    while (sense_.load(std::memory_order_seq_cst) == sense) {
+      futex::Wait(sense_, sense);
+    }
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void ArriveAndWait() {
+    ArriveAndWait([]() {});
+  }
+
+  [[nodiscard]] uint32_t count() const noexcept { return count_; }
+
+ private:
+  alignas(64) std::atomic<uint32_t> arrived_ = 0;
+  // Incremented on every completed round, threads wait until it changes.
+  alignas(64) std::atomic<uint32_t> sense_ = 0;
+  std::atomic<uint32_t> sleepers_ = 0;
+
+  const uint32_t count_;
+  const uint32_t spin_count_;
+};
+}  // namespace engine::core
@@ -0,0 +1,170 @@
+#include "TickPacer.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <time.h>
+
+#include <cerrno>
+#endif
+
+namespace engine::core {
+void JitterHistogram::Record(std::chrono::nanoseconds value) noexcept {
+  const int64_t ns = std::max<int64_t>(value.count(), 0);
+  size_t index = 0;
+  while (index + 1 < kBuckets && (int64_t(1) << (index + 1)) <= ns) {
+    index++;
+  }
+  buckets_[index].store(buckets_[index].load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
+  count_.store(count_.load(std::memory_order_relaxed) + 1,
+               std::memory_order_relaxed);
+  if (ns > max_.load(std::memory_order_relaxed)) {
+    max_.store(ns, std::memory_order_relaxed);
+  }
+}
+
+std::chrono::nanoseconds JitterHistogram::quantile(double q) const noexcept {
+  const uint64_t total = count();
+  if (total == 0) {
+    return std::chrono::nanoseconds(0);
+  }
+  const auto target = uint64_t(q * double(total));
+  uint64_t accumulated = 0;
+  for (size_t i = 0; i < kBuckets; i++) {
+    accumulated += bucket(i);
+    if (accumulated > target) {
+      return std::min(std::chrono::nanoseconds(int64_t(1) << (i + 1)), max());
+    }
+  }
+  return max();
+}
+
+void JitterHistogram::WriteJson(std::ostream& out) const {
+  out << "{\"count\":" << count() << ",\"max_ns\":" << max().count()
+      << ",\"p50_ns\":" << quantile(0.5).count()
+      << ",\"p99_ns\":" << quantile(0.99).count() << ",\"buckets\":[";
+  bool first = true;
+  for (size_t i = 0; i < kBuckets; i++) {
+    if (bucket(i) == 0) {
+      continue;
+    }
+    out << (first ? "" : ",") << "[" << (int64_t(1) << (i + 1)) << ","
+        << bucket(i) << "]";
+    first = false;
+  }
+  out << "]}";
+}
+
+TickPacer::TickPacer(std::chrono::nanoseconds overhead)
+    : overhead_(overhead) {}
+
+std::chrono::nanoseconds TickPacer::CalibrateSpinWindow(
+    std::chrono::nanoseconds overhead) {
+  using namespace std::chrono;
+  constexpr size_t tests = 32;
+  constexpr auto timer = 250us;
+  constexpr nanoseconds min_window = 50us;
+  constexpr nanoseconds max_window = 2ms;
+
+  std::vector<nanoseconds> lateness(tests);
+  for (auto& late : lateness) {
+    auto deadline = Clock::now() + timer;
+    SleepUntil(deadline);
+    late = Clock::now() - deadline;
+  }
+  std::sort(lateness.begin(), lateness.end());
+  // leave the worst wake up out, it is usually a one-off preemption
+  nanoseconds window = lateness[tests - 2] + overhead;
+  return std::clamp(window, min_window, max_window);
+}
+
+void TickPacer::SleepUntil(Clock::time_point deadline) {
+#if defined(__linux__)
+  // steady_clock is CLOCK_MONOTONIC on linux
+  auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         deadline.time_since_epoch())
+                         .count();
+  timespec ts;
+  ts.tv_sec = time_t(since_epoch / 1000000000);
+  ts.tv_nsec = long(since_epoch % 1000000000);
+  // sleep again if interrupted by a signal, on other errors WaitUntil spins
+  // for the rest of the time
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+         EINTR) {
+  }
+#else
+  std::this_thread::sleep_until(deadline);
+#endif
+}
+
+std::chrono::nanoseconds TickPacer::CalibratedSpinWindow() {
+  int64_t window = spin_window_.load(std::memory_order_relaxed);
+  if (window == kUncalibrated) [[unlikely]] {
+    // it takes 10ms and measures the OS timer, not the instance, so only
+    // the first paced Core of a process waits for it
+    static const std::chrono::nanoseconds calibrated =
+        CalibrateSpinWindow(overhead_);
+    // a window set in the meantime wins
+    window = calibrated.count();
+    int64_t expected = kUncalibrated;
+    if (!spin_window_.compare_exchange_strong(expected, window,
+                                              std::memory_order_relaxed)) {
+      window = expected;
+    }
+  }
+  return std::chrono::nanoseconds(window);
+}
+
+void TickPacer::WaitUntil(Clock::time_point deadline) {
+  if (mode() == Mode::kUnpaced) {
+    return;
+  }
+  deadline -= overhead_;
+  const auto start = Clock::now();
+  if (start >= deadline) {
+    lateness_.Record(start - deadline);
+    return;
+  }
+
+  const Mode mode = this->mode();
+  if (mode != Mode::kBusySpin) {
+    const auto sleep_deadline =
+        mode == Mode::kSleep ? deadline : deadline - CalibratedSpinWindow();
+    if (sleep_deadline > start) {
+      SleepUntil(sleep_deadline);
+      const auto woke_up = Clock::now();
+      oversleep_.Record(woke_up - sleep_deadline);
+      sleep_time_.store(
+          sleep_time_.load(std::memory_order_relaxed) +
+              std::chrono::nanoseconds(woke_up - start).count(),
+          std::memory_order_relaxed);
+    }
+  }
+
+  const auto spin_start = Clock::now();
+  auto now = spin_start;
+  while (now < deadline) {
+    now = Clock::now();
+  }
+  spin_time_.store(spin_time_.load(std::memory_order_relaxed) +
+                       std::chrono::nanoseconds(now - spin_start).count(),
+                   std::memory_order_relaxed);
+  lateness_.Record(now - deadline);
+}
+
+void TickPacer::WriteJson(std::ostream& out) const {
+  static constexpr const char* kModeNames[] = {"busy_spin", "hybrid", "sleep",
+                                               "unpaced"};
+  out << "{\"mode\":\"" << kModeNames[size_t(mode())]
+      << "\",\"spin_window_ns\":" << spin_window().count()
+      << ",\"spin_time_ns\":" << spin_time().count()
+      << ",\"sleep_time_ns\":" << sleep_time().count() << ",\"lateness\":";
+  lateness_.WriteJson(out);
+  out << ",\"oversleep\":";
+  oversleep_.WriteJson(out);
+  out << "}";
+}
+}  // namespace engine::core
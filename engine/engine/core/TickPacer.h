@@ -0,0 +1,126 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace engine::core {
+/// <summary>
+/// Histogram with power of two buckets: bucket i counts values in
+/// [2^i, 2^(i + 1)) nanoseconds, zero goes to the first bucket.
+/// Written by a single thread, can be read from any thread.
+/// </summary>
+class JitterHistogram {
+ public:
+  static constexpr size_t kBuckets = 40;
+
+  void Record(std::chrono::nanoseconds value) noexcept;
+
+  [[nodiscard]] uint64_t count() const noexcept {
+    return count_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::chrono::nanoseconds max() const noexcept {
+    return std::chrono::nanoseconds(max_.load(std::memory_order_relaxed));
+  }
+  [[nodiscard]] uint64_t bucket(size_t index) const noexcept {
+    return buckets_[index].load(std::memory_order_relaxed);
+  }
+  // Returns the upper bound of the bucket which contains the given quantile.
+  [[nodiscard]] std::chrono::nanoseconds quantile(double q) const noexcept;
+
+  // Writes {"count":..,"max_ns":..,"buckets":[[upper_bound_ns,count],..]}
+  void WriteJson(std::ostream& out) const;
+
+ private:
+  std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+  std::atomic<uint64_t> count_ = 0;
+  std::atomic<int64_t> max_ = 0;
+};
+
+/// <summary>
+/// Waits for the beginning of the next tick.
+///
+/// kBusySpin spins on steady_clock for the whole gap. It has the lowest
+/// jitter, but burns a whole core even if the engine is idle.
+/// kHybrid sleeps on the absolute deadline minus the spin window and then
+/// spins for the rest, so the core is busy only for the last spin_window.
+/// kSleep relies on the OS timer only.
+/// kUnpaced doesn't wait at all, ticks run back to back. It is meant for
+/// headless replays and benchmarks.
+///
+/// Lateness of every wake up and oversleep of the coarse sleep are recorded
+/// into histograms, so the spin window can be chosen per deployment.
+/// Unless it is set, the spin window is calibrated by the first kHybrid wait,
+/// once per process, so pacers which never sleep don't pay for it.
+/// </summary>
+class TickPacer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Mode { kBusySpin, kHybrid, kSleep, kUnpaced };
+
+  // overhead is the cost of reading the time, it is subtracted from every
+  // deadline
+  explicit TickPacer(std::chrono::nanoseconds overhead);
+
+  // Measures how late the OS wakes us up after an absolute sleep and returns
+  // the spin window which covers almost all of the wake ups.
+  [[nodiscard]] static std::chrono::nanoseconds CalibrateSpinWindow(
+      std::chrono::nanoseconds overhead);
+
+  void WaitUntil(Clock::time_point deadline);
+
+  [[nodiscard]] Mode mode() const noexcept {
+    return mode_.load(std::memory_order_relaxed);
+  }
+  void SetMode(Mode mode) noexcept {
+    mode_.store(mode, std::memory_order_relaxed);
+  }
+
+  // Zero until it is set or calibrated.
+  [[nodiscard]] std::chrono::nanoseconds spin_window() const noexcept {
+    return std::chrono::nanoseconds(
+        std::max<int64_t>(spin_window_.load(std::memory_order_relaxed), 0));
+  }
+  void SetSpinWindow(std::chrono::nanoseconds window) noexcept {
+    spin_window_.store(window.count(), std::memory_order_relaxed);
+  }
+
+  // How late we woke up relative to the deadline
+  [[nodiscard]] JitterHistogram const& lateness() const noexcept {
+    return lateness_;
+  }
+  // How late the coarse sleep returned relative to its own target
+  [[nodiscard]] JitterHistogram const& oversleep() const noexcept {
+    return oversleep_;
+  }
+  // Total time spent spinning and sleeping
+  [[nodiscard]] std::chrono::nanoseconds spin_time() const noexcept {
+    return std::chrono::nanoseconds(spin_time_.load(std::memory_order_relaxed));
+  }
+  [[nodiscard]] std::chrono::nanoseconds sleep_time() const noexcept {
+    return std::chrono::nanoseconds(
+        sleep_time_.load(std::memory_order_relaxed));
+  }
+
+  void WriteJson(std::ostream& out) const;
+
+ private:
+  static constexpr int64_t kUncalibrated = -1;
+
+  static void SleepUntil(Clock::time_point deadline);
+  // spin_window, calibrated on the first call if it wasn't set
+  [[nodiscard]] std::chrono::nanoseconds CalibratedSpinWindow();
+
+  const std::chrono::nanoseconds overhead_;
+  std::atomic<Mode> mode_ = Mode::kHybrid;
+  std::atomic<int64_t> spin_window_ = kUncalibrated;
+
+  JitterHistogram lateness_;
+  JitterHistogram oversleep_;
+  std::atomic<int64_t> spin_time_ = 0;
+  std::atomic<int64_t> sleep_time_ = 0;
+};
+}  // namespace engine::core
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+
+namespace engine::core {
+// Identifier of a tick phase.
+// Phases are executed in each tick according to their dependencies, phases
+// which don't depend on each other can run at the same time.
+using PhaseId = uint8_t;
+
+namespace phase {
+// Maximum amount of phases, including the built-in ones
+constexpr PhaseId kMaxPhases = 32;
+
+// Built-in phases, each one depends on the previous one.
+constexpr PhaseId kPreUpdate = 0;
+constexpr PhaseId kUpdate = 1;
+constexpr PhaseId kPostUpdate = 2;
+// Overlaps the next tick: render extraction of tick N can still run while
+// tick N + 1 is simulated.
+constexpr PhaseId kRenderExtract = 3;
+
+constexpr PhaseId kBuiltinCount = 4;
+}  // namespace phase
+}  // namespace engine::core
@@ -0,0 +1,235 @@
+#include "TickSchedule.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace engine::core {
+namespace {
+// Ticks of the offset of the tickrate hit every wheel slot congruent to the
+// offset modulo gcd(tickrate, kWheelSlots).
+uint32_t SlotStep(uint32_t tickrate) noexcept {
+  return std::gcd(tickrate, uint32_t(TickSchedule::kWheelSlots));
+}
+}  // namespace
+
+void TickSchedule::Add(Ticker* object, uint32_t tickrate, uint32_t offset) {
+  tickrate = std::max(tickrate, 1U);
+  Rate& rate = FindOrAddRate(tickrate);
+  offset = offset == Ticker::kAutoTickOffset ? ChooseOffset(rate)
+                                             : offset % tickrate;
+  Bucket& bucket = rate.buckets[offset];
+  Place(object, tickrate, offset, bucket);
+  // the estimate is replaced by the measured cost when the bucket is due
+  bucket.cost_ns += object_cost_ns_;
+  AddToWheel(tickrate, offset, double(object_cost_ns_));
+  size_++;
+}
+
+bool TickSchedule::Remove(Ticker& object) {
+  Rate* rate = FindRate(object.scheduled_tickrate_);
+  if (rate == nullptr) {
+    return false;
+  }
+  Bucket& bucket = rate->buckets[object.scheduled_offset_];
+  const size_t index = object.scheduled_index_;
+  if (index >= bucket.objects.size() || bucket.objects[index] != &object) {
+    return false;
+  }
+  Erase(bucket, index);
+  object.scheduled_tickrate_ = 0;
+  size_--;
+  return true;
+}
+
+void TickSchedule::Place(Ticker* object, uint32_t tickrate, uint32_t offset,
+                         Bucket& bucket) {
+  object->scheduled_tickrate_ = tickrate;
+  object->scheduled_offset_ = offset;
+  object->scheduled_index_ = uint32_t(bucket.objects.size());
+  bucket.objects.push_back(object);
+}
+
+void TickSchedule::Erase(Bucket& bucket, size_t index) {
+  // order inside the bucket doesn't matter
+  if (index + 1 != bucket.objects.size()) {
+    bucket.objects[index] = bucket.objects.back();
+    bucket.objects[index]->scheduled_index_ = uint32_t(index);
+  }
+  bucket.objects.pop_back();
+}
+
+TickSchedule::Rate* TickSchedule::FindRate(uint32_t tickrate) noexcept {
+  auto rate = std::lower_bound(
+      rates_.begin(), rates_.end(), tickrate,
+      [](Rate const& r, uint32_t value) { return r.tickrate < value; });
+  return rate == rates_.end() || rate->tickrate != tickrate ? nullptr
+                                                            : &*rate;
+}
+
+TickSchedule::Rate& TickSchedule::FindOrAddRate(uint32_t tickrate) {
+  auto rate = std::lower_bound(
+      rates_.begin(), rates_.end(), tickrate,
+      [](Rate const& r, uint32_t value) { return r.tickrate < value; });
+  if (rate == rates_.end() || rate->tickrate != tickrate) {
+    rate = rates_.insert(rate, Rate{tickrate, std::vector<Bucket>(tickrate)});
+  }
+  return *rate;
+}
+
+void TickSchedule::Refresh(Bucket& bucket, uint32_t tickrate) {
+  auto& objects = bucket.objects;
+  for (size_t i = 0; i < objects.size();) {
+    Ticker* object = objects[i];
+    if (std::max(object->tickrate(), 1U) == tickrate) {
+      i++;
+      continue;
+    }
+    Erase(bucket, i);
+    object->scheduled_tickrate_ = 0;
+    size_--;
+    rescheduled_.push_back(object);
+  }
+}
+
+void TickSchedule::AddToWheel(uint32_t tickrate, uint32_t offset,
+                              double cost) noexcept {
+  const uint32_t step = SlotStep(tickrate);
+  // the bucket is due once per tickrate ticks, while the slot is visited once
+  // per kWheelSlots ticks, so the slot gets the average share of the cost
+  const double share = cost * double(step) / double(tickrate);
+  for (size_t slot = offset % step; slot < kWheelSlots; slot += step) {
+    wheel_[slot] = std::max(wheel_[slot] + share, 0.0);
+  }
+}
+
+double TickSchedule::PeakCost(uint32_t tickrate,
+                              uint32_t offset) const noexcept {
+  const uint32_t step = SlotStep(tickrate);
+  double peak = 0;
+  for (size_t slot = offset % step; slot < kWheelSlots; slot += step) {
+    peak = std::max(peak, wheel_[slot]);
+  }
+  return peak;
+}
+
+uint32_t TickSchedule::ChooseOffset(Rate const& rate) const noexcept {
+  uint32_t best = 0;
+  double best_peak = 0;
+  for (uint32_t offset = 0; offset < rate.tickrate; offset++) {
+    const double peak = PeakCost(rate.tickrate, offset);
+    if (offset == 0 || peak < best_peak ||
+        (peak == best_peak &&
+         rate.buckets[offset].cost_ns < rate.buckets[best].cost_ns)) {
+      best = offset;
+      best_peak = peak;
+    }
+  }
+  return best;
+}
+
+void TickSchedule::RebuildWheel() {
+  wheel_.fill(0);
+  uint64_t total_cost = 0;
+  size_t total_objects = 0;
+  for (auto& rate : rates_) {
+    for (uint32_t offset = 0; offset < rate.tickrate; offset++) {
+      Bucket const& bucket = rate.buckets[offset];
+      if (bucket.objects.empty()) {
+        continue;
+      }
+      AddToWheel(rate.tickrate, offset, double(bucket.cost_ns));
+      total_cost += bucket.cost_ns;
+      total_objects += bucket.objects.size();
+    }
+  }
+  if (total_objects != 0 && total_cost != 0) {
+    object_cost_ns_ = std::max<uint64_t>(total_cost / total_objects, 1);
+  }
+}
+
+void TickSchedule::Rebalance() {
+  RebuildWheel();
+  for (size_t moves = 0; moves < kMaxMovesPerRebalance; moves++) {
+    const auto peak = std::max_element(wheel_.begin(), wheel_.end());
+    const double mean =
+        std::accumulate(wheel_.begin(), wheel_.end(), 0.0) / kWheelSlots;
+    if (mean == 0 || *peak <= mean * (1 + kImbalanceThreshold) ||
+        !MoveFromSlot(size_t(peak - wheel_.begin()))) {
+      return;
+    }
+  }
+}
+
+bool TickSchedule::MoveFromSlot(size_t slot) {
+  // buckets which are due on the ticks of the slot, the most expensive first
+  struct Candidate {
+    double share;
+    Rate* rate;
+    uint32_t offset;
+  };
+  std::vector<Candidate> candidates;
+  for (auto& rate : rates_) {
+    const uint32_t step = SlotStep(rate.tickrate);
+    for (uint32_t offset = uint32_t(slot % step); offset < rate.tickrate;
+         offset += step) {
+      Bucket const& bucket = rate.buckets[offset];
+      if (bucket.cost_ns != 0 && !bucket.objects.empty()) {
+        candidates.push_back(
+            {double(bucket.cost_ns) * step / rate.tickrate, &rate, offset});
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](Candidate const& a, Candidate const& b) {
+              return a.share > b.share;
+            });
+
+  const double slot_cost = wheel_[slot];
+  for (auto const& candidate : candidates) {
+    Rate& rate = *candidate.rate;
+    Bucket& bucket = rate.buckets[candidate.offset];
+
+    // the most expensive object which can be moved; only relative update
+    // times matter, the absolute cost is the share of the measured bucket cost
+    size_t index = bucket.objects.size();
+    double index_time = -1;
+    double total_time = 0;
+    for (size_t i = 0; i < bucket.objects.size(); i++) {
+      Ticker const* object = bucket.objects[i];
+      const double time = object->latency().mean_ns();
+      total_time += time;
+      if (object->tick_offset() == Ticker::kAutoTickOffset &&
+          time > index_time) {
+        index = i;
+        index_time = time;
+      }
+    }
+    if (index == bucket.objects.size()) {
+      continue;
+    }
+    const uint64_t cost =
+        total_time > 0
+            ? uint64_t(double(bucket.cost_ns) * index_time / total_time)
+            : bucket.cost_ns / bucket.objects.size();
+
+    AddToWheel(rate.tickrate, candidate.offset, -double(cost));
+    const uint32_t target = ChooseOffset(rate);
+    const double target_peak = PeakCost(rate.tickrate, target) +
+                               double(cost) * SlotStep(rate.tickrate) /
+                                   rate.tickrate;
+    if (target == candidate.offset || target_peak >= slot_cost) {
+      AddToWheel(rate.tickrate, candidate.offset, double(cost));
+      continue;
+    }
+
+    Bucket& target_bucket = rate.buckets[target];
+    Place(bucket.objects[index], rate.tickrate, target, target_bucket);
+    Erase(bucket, index);
+    bucket.cost_ns -= std::min(bucket.cost_ns, cost);
+    target_bucket.cost_ns += cost;
+    AddToWheel(rate.tickrate, target, double(cost));
+    return true;
+  }
+  return false;
+}
+}  // namespace engine::core
@@ -0,0 +1,159 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "engine/Ticker.h"
+
+namespace engine::core {
+/// <summary>
+/// Objects grouped by tickrate and by the tick offset inside the tickrate.
+/// An object with tickrate N and offset K is updated on ticks where
+/// tick % N == K, so on each tick only one bucket per distinct tickrate is
+/// visited and objects that are not due are never touched.
+///
+/// Objects with Ticker::kAutoTickOffset get the offset with the lowest
+/// expected cost, so e.g. objects with tickrate 8 are spread over 8 ticks
+/// instead of all of them being updated on every 8th tick. The expected cost
+/// of every tick is kept in a wheel of kWheelSlots ticks, which is rebuilt
+/// from the measured update time of the buckets every kWheelSlots ticks.
+/// After the rebuild the most expensive objects are moved out of the
+/// overloaded slots, a few of them at a time.
+///
+/// If the schedule isn't adaptive, measured costs are ignored, so the offsets
+/// depend only on the order in which objects were added.
+/// </summary>
+class TickSchedule {
+ public:
+  struct Bucket {
+    std::vector<Ticker*> objects;
+    // Update time of the objects in nanoseconds, measured the last time the
+    // bucket was due, or estimated if the bucket wasn't updated yet.
+    uint64_t cost_ns = 0;
+    // Accumulated by the jobs of the current run, can be written by any
+    // thread. Moved into cost_ns when the bucket is due next time.
+    std::atomic<uint64_t> running_cost_ns = 0;
+  };
+
+  static constexpr size_t kWheelSlots = 64;
+  // Cost of an object if nothing was measured yet
+  static constexpr uint64_t kDefaultObjectCostNs = 1000;
+  // The wheel is balanced if no slot exceeds the mean by more than this
+  static constexpr double kImbalanceThreshold = 0.25;
+  // Objects moved between offsets per rebalance
+  static constexpr size_t kMaxMovesPerRebalance = 4;
+
+  // Tickrate zero means that the object should be updated every tick.
+  // Offset is taken modulo tickrate, kAutoTickOffset lets the schedule
+  // choose it. The object should stay alive until it is removed.
+  void Add(Ticker* object, uint32_t tickrate,
+           uint32_t offset = Ticker::kAutoTickOffset);
+
+  // O(1), the position of the object is stored in the object itself.
+  // Returns false if the object isn't in this schedule.
+  // Shouldn't be called while the buckets are used by jobs.
+  bool Remove(Ticker& object);
+
+  // Moves objects whose tickrate was changed from the buckets that are due on
+  // this tick into the right bucket, then calls function(Bucket&) for every
+  // non-empty due bucket.
+  template <typename Function>
+  void ForEachDue(uint64_t tick, Function&& function) {
+    if (adaptive_ && tick >= next_rebalance_tick_) {
+      next_rebalance_tick_ = tick + kWheelSlots;
+      Rebalance();
+    }
+    for (size_t i = 0; i < rates_.size(); i++) {
+      const uint32_t tickrate = rates_[i].tickrate;
+      Bucket& bucket = rates_[i].buckets[tick % tickrate];
+      if (bucket.objects.empty()) {
+        continue;
+      }
+      bucket.cost_ns =
+          bucket.running_cost_ns.exchange(0, std::memory_order_relaxed);
+      Refresh(bucket, tickrate);
+      if (!bucket.objects.empty()) {
+        function(bucket);
+      }
+    }
+    // added after the loop, so new tickrates don't shift rates_ under it
+    for (Ticker* object : rescheduled_) {
+      Add(object, object->tickrate(), object->tick_offset());
+    }
+    rescheduled_.clear();
+  }
+
+  // Calls function(Bucket&) for every bucket.
+  template <typename Function>
+  void ForEach(Function&& function) {
+    for (auto& rate : rates_) {
+      for (auto& bucket : rate.buckets) {
+        function(bucket);
+      }
+    }
+  }
+
+  // Amount of objects.
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+
+  // Should be changed before objects are added, otherwise offsets of the
+  // already added objects may still depend on the measured costs.
+  void SetAdaptive(bool adaptive) noexcept { adaptive_ = adaptive; }
+  [[nodiscard]] bool adaptive() const noexcept { return adaptive_; }
+
+  // Expected cost in nanoseconds of the ticks where tick % kWheelSlots == slot.
+  [[nodiscard]] double slot_cost(size_t slot) const noexcept {
+    return wheel_[slot % kWheelSlots];
+  }
+
+ private:
+  struct Rate {
+    uint32_t tickrate;
+    // buckets[offset]
+    std::vector<Bucket> buckets;
+  };
+
+  void Refresh(Bucket& bucket, uint32_t tickrate);
+
+  // Rebuilds the wheel from the bucket costs and moves the most expensive
+  // objects out of the overloaded slots.
+  void Rebalance();
+  void RebuildWheel();
+  // Adds cost of a bucket of the given tickrate to the wheel slots it hits.
+  void AddToWheel(uint32_t tickrate, uint32_t offset, double cost) noexcept;
+  // Returns the offset of the tickrate whose most expensive wheel slot is the
+  // cheapest one, bucket cost breaks ties.
+  [[nodiscard]] uint32_t ChooseOffset(Rate const& rate) const noexcept;
+  // Highest wheel cost among the slots the offset of the tickrate hits.
+  [[nodiscard]] double PeakCost(uint32_t tickrate,
+                                uint32_t offset) const noexcept;
+  // Moves the most expensive object with the automatic offset out of the
+  // slot. Returns false if nothing can be moved without making it worse.
+  bool MoveFromSlot(size_t slot);
+
+  Rate& FindOrAddRate(uint32_t tickrate);
+  // Returns nullptr if there are no objects with this tickrate.
+  Rate* FindRate(uint32_t tickrate) noexcept;
+
+  // Puts the object at the end of the bucket and remembers the position.
+  static void Place(Ticker* object, uint32_t tickrate, uint32_t offset,
+                    Bucket& bucket);
+  // Swaps the object at the index with the last one and removes it.
+  static void Erase(Bucket& bucket, size_t index);
+
+  // rates_ are sorted by tickrate and are never removed, so there are only as
+  // many of them as there are distinct tickrates.
+  std::vector<Rate> rates_;
+  std::vector<Ticker*> rescheduled_;
+  size_t size_ = 0;
+
+  std::array<double, kWheelSlots> wheel_{};
+  // estimate for the objects which weren't measured yet
+  uint64_t object_cost_ns_ = kDefaultObjectCostNs;
+  uint64_t next_rebalance_tick_ = 0;
+  bool adaptive_ = true;
+};
+}  // namespace engine::core
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+
+namespace engine::core {
+// Generational handle of a ticker in the TickerRegistry.
+// The slot index is reused after the object is removed, the generation is
+// not, so a stale handle never refers to another object.
+struct TickerHandle {
+  uint32_t index = 0;
+  // zero generation is never used by a registered object
+  uint32_t generation = 0;
+
+  [[nodiscard]] bool valid() const noexcept { return generation != 0; }
+  bool operator==(TickerHandle const&) const = default;
+};
+}  // namespace engine::core
@@ -0,0 +1,50 @@
+#include "TickerRegistry.h"
+
+#include <utility>
+
+namespace engine::core {
+TickerHandle TickerRegistry::Add(std::shared_ptr<Ticker> object) {
+  uint32_t slot = free_slot_;
+  if (slot == kNoFreeSlot) {
+    slot = uint32_t(slots_.size());
+    slots_.emplace_back();
+  } else {
+    free_slot_ = slots_[slot].index;
+  }
+  slots_[slot].index = uint32_t(dense_.size());
+  const TickerHandle handle{slot, slots_[slot].generation};
+  object->handle_ = handle;
+  dense_.push_back({std::move(object), slot});
+  return handle;
+}
+
+std::shared_ptr<Ticker> TickerRegistry::Remove(TickerHandle handle) {
+  if (Get(handle) == nullptr) {
+    return nullptr;
+  }
+  Slot& slot = slots_[handle.index];
+  const uint32_t index = slot.index;
+  std::shared_ptr<Ticker> object = std::move(dense_[index].object);
+  object->handle_ = TickerHandle{};
+
+  if (index + 1 != dense_.size()) {
+    dense_[index] = std::move(dense_.back());
+    slots_[dense_[index].slot].index = index;
+  }
+  dense_.pop_back();
+
+  // generation zero is reserved for invalid handles
+  slot.generation = slot.generation + 1 == 0 ? 1 : slot.generation + 1;
+  slot.index = free_slot_;
+  free_slot_ = handle.index;
+  return object;
+}
+
+Ticker* TickerRegistry::Get(TickerHandle handle) const noexcept {
+  if (!handle.valid() || handle.index >= slots_.size() ||
+      slots_[handle.index].generation != handle.generation) {
+    return nullptr;
+  }
+  return dense_[slots_[handle.index].index].object.get();
+}
+}  // namespace engine::core
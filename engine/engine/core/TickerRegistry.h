@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "engine/Ticker.h"
+#include "engine/core/TickerHandle.h"
+
+namespace engine::core {
+/// <summary>
+/// Slot map which owns tickers.
+/// Objects are stored densely, so iterating over them touches neither
+/// reference counters nor holes. Removal swaps the last object into the
+/// freed place, the sparse slots translate handles into dense indices.
+/// Not thread safe, every UpdateThread has its own registry.
+/// </summary>
+class TickerRegistry {
+ public:
+  // Takes ownership of the object and writes the handle into it.
+  TickerHandle Add(std::shared_ptr<Ticker> object);
+
+  // Returns the removed object, so the caller decides where it is destroyed.
+  // Returns nullptr if the handle is stale.
+  std::shared_ptr<Ticker> Remove(TickerHandle handle);
+
+  // Returns nullptr if the handle is stale.
+  [[nodiscard]] Ticker* Get(TickerHandle handle) const noexcept;
+
+  // Calls function(std::shared_ptr<Ticker> const&) for every object.
+  template <typename Function>
+  void ForEach(Function&& function) const {
+    for (auto const& entry : dense_) {
+      function(entry.object);
+    }
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return dense_.size(); }
+
+ private:
+  struct Slot {
+    uint32_t generation = 1;
+    // index in dense_ if the slot is used, the next free slot otherwise
+    uint32_t index = 0;
+  };
+  struct Entry {
+    std::shared_ptr<Ticker> object;
+    uint32_t slot;
+  };
+
+  static constexpr uint32_t kNoFreeSlot = UINT32_MAX;
+
+  std::vector<Entry> dense_;
+  std::vector<Slot> slots_;
+  uint32_t free_slot_ = kNoFreeSlot;
+};
+}  // namespace engine::core
@@ -0,0 +1,139 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string_view>
+
+namespace engine::core {
+std::mutex Trace::mutex_;
+std::vector<Trace::Buffer*> Trace::buffers_;
+
+namespace {
+void WriteString(std::ostream& out, std::string_view value) {
+  out << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out << ' ';
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+
+// Chrome expects microseconds, the fraction keeps the nanoseconds.
+void WriteMicroseconds(std::ostream& out, uint64_t ns) {
+  const uint64_t fraction = ns % 1000;
+  out << ns / 1000 << '.' << char('0' + fraction / 100)
+      << char('0' + fraction / 10 % 10) << char('0' + fraction % 10);
+}
+}  // namespace
+
+Trace::Buffer* Trace::CreateBuffer() {
+  auto buffer = new Buffer();
+  std::scoped_lock<std::mutex> lock(mutex_);
+  buffer->tid = uint32_t(buffers_.size() + 1);
+  buffers_.push_back(buffer);
+  return buffer;
+}
+
+Trace::Buffer& Trace::ThreadBuffer() {
+  thread_local Buffer* buffer = CreateBuffer();
+  return *buffer;
+}
+
+void Trace::Record(const char* name, uint64_t start_ns,
+                   uint64_t end_ns) noexcept {
+  Buffer& buffer = ThreadBuffer();
+  const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+  Event& event = buffer.events[head % kBufferSize];
+  // orders the overwrite after the publication of the previous event, so a
+  // reader which sees the new data also sees that the slot was reused
+  std::atomic_thread_fence(std::memory_order_release);
+  event.name.store(name, std::memory_order_relaxed);
+  event.start_ns.store(start_ns, std::memory_order_relaxed);
+  event.end_ns.store(end_ns, std::memory_order_relaxed);
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Trace::SetThreadName(std::string name) {
+  Buffer& buffer = ThreadBuffer();
+  std::scoped_lock<std::mutex> lock(mutex_);
+  buffer.name = std::move(name);
+}
+
+void Trace::WriteJson(std::ostream& out) {
+  struct Copy {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+  };
+  std::vector<Copy> events;
+
+  std::scoped_lock<std::mutex> lock(mutex_);
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  for (Buffer* buffer : buffers_) {
+    if (!buffer->name.empty()) {
+      out << (first ? "" : ",")
+          << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+          << buffer->tid << ",\"args\":{\"name\":";
+      WriteString(out, buffer->name);
+      out << "}}";
+      first = false;
+    }
+
+    const uint64_t head = buffer->head.load(std::memory_order_acquire);
+    const uint64_t begin =
+        std::max(buffer->tail.load(std::memory_order_relaxed),
+                 head > kBufferSize ? head - kBufferSize : 0);
+    events.clear();
+    for (uint64_t i = begin; i < head; i++) {
+      Event const& event = buffer->events[i % kBufferSize];
+      events.push_back({event.name.load(std::memory_order_relaxed),
+                        event.start_ns.load(std::memory_order_relaxed),
+                        event.end_ns.load(std::memory_order_relaxed)});
+    }
+    // The owner keeps recording while we copy. Events it could have
+    // overwritten in the meantime are dropped, including the one it may be
+    // writing right now.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t after = buffer->head.load(std::memory_order_relaxed);
+    const uint64_t valid = after >= kBufferSize ? after - kBufferSize + 1 : 0;
+
+    for (uint64_t i = std::max(begin, valid); i < head; i++) {
+      Copy const& event = events[i - begin];
+      out << (first ? "" : ",") << "{\"name\":";
+      WriteString(out, event.name == nullptr ? "" : event.name);
+      out << ",\"cat\":\"engine\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+          << buffer->tid << ",\"ts\":";
+      WriteMicroseconds(out, event.start_ns);
+      out << ",\"dur\":";
+      WriteMicroseconds(out, event.end_ns - std::min(event.start_ns,
+                                                     event.end_ns));
+      out << "}";
+      first = false;
+    }
+  }
+  out << "],\"displayTimeUnit\":\"ns\"}";
+}
+
+bool Trace::WriteFile(std::string const& path) {
+  std::ofstream file(path, std::ios::out | std::ios::trunc);
+  if (!file.is_open()) {
+    return false;
+  }
+  WriteJson(file);
+  return bool(file);
+}
+
+void Trace::Clear() noexcept {
+  std::scoped_lock<std::mutex> lock(mutex_);
+  for (Buffer* buffer : buffers_) {
+    buffer->tail.store(buffer->head.load(std::memory_order_acquire),
+                       std::memory_order_relaxed);
+  }
+}
+}  // namespace engine::core
@@ -0,0 +1,107 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "engine/core/Clock.h"
+
+namespace engine::core {
+/// <summary>
+/// Timeline instrumentation exported in the Chrome Trace Event format, which
+/// is opened by chrome://tracing and ui.perfetto.dev.
+///
+/// Every thread writes the completed scopes into its own ring buffer, so
+/// recording takes two clock reads and a few stores, without locks. The
+/// buffer keeps the last kBufferSize - 1 events of the thread, older ones are
+/// overwritten. WriteJson can be called at any moment from any thread.
+///
+/// Scopes are recorded only if the engine is built with ENGINE_TRACE
+/// defined, otherwise ENGINE_TRACE_SCOPE expands to nothing.
+/// </summary>
+class Trace {
+ public:
+  static constexpr size_t kBufferSize = size_t(1) << 16;
+
+  // The name should be a string literal, only the pointer is stored.
+  static void Record(const char* name, uint64_t start_ns,
+                     uint64_t end_ns) noexcept;
+
+  // Name of the calling thread in the timeline.
+  static void SetThreadName(std::string name);
+
+  // Writes {"traceEvents":[..]} with the events of every thread that has
+  // recorded something.
+  static void WriteJson(std::ostream& out);
+  // Returns false if the file can't be written.
+  static bool WriteFile(std::string const& path);
+
+  // Forgets recorded events of every thread, e.g. to capture a single
+  // level load.
+  static void Clear() noexcept;
+
+ private:
+  struct Event {
+    std::atomic<const char*> name = nullptr;
+    std::atomic<uint64_t> start_ns = 0;
+    std::atomic<uint64_t> end_ns = 0;
+  };
+
+  // Written only by its thread. Buffers are never freed, so the events of
+  // threads that have exited are still exported.
+  struct Buffer {
+    std::atomic<uint64_t> head = 0;
+    // events below it are ignored by WriteJson, see Clear
+    std::atomic<uint64_t> tail = 0;
+    uint32_t tid = 0;
+    // guarded by mutex_
+    std::string name;
+    std::array<Event, kBufferSize> events;
+  };
+
+  static Buffer& ThreadBuffer();
+  static Buffer* CreateBuffer();
+
+  static std::mutex mutex_;
+  static std::vector<Buffer*> buffers_;
+};
+
+// Records the lifetime of the scope.
+class TraceScope {
+ public:
+  explicit TraceScope(const char* name) noexcept
+      : name_(name), start_ns_(Clock::now_ns()) {}
+  ~TraceScope() { Trace::Record(name_, start_ns_, Clock::now_ns()); }
+
+  /* Disable copy and move semantics. */
+  TraceScope(const TraceScope&) = delete;
+  TraceScope(TraceScope&&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+  TraceScope& operator=(TraceScope&&) = delete;
+
+ private:
+  const char* name_;
+  uint64_t start_ns_;
+};
+}  // namespace engine::core
+
+#define ENGINE_TRACE_CONCAT_IMPL(a, b) a##b
+#define ENGINE_TRACE_CONCAT(a, b) ENGINE_TRACE_CONCAT_IMPL(a, b)
+
+#if defined(ENGINE_TRACE)
+#define ENGINE_TRACE_SCOPE(name)                   \
+  ::engine::core::TraceScope ENGINE_TRACE_CONCAT( \
+      engine_trace_scope_, __LINE__)(name)
+// For code which already measures the time itself.
+#define ENGINE_TRACE_RECORD(name, start_ns, end_ns) \
+  ::engine::core::Trace::Record(name, start_ns, end_ns)
+#define ENGINE_TRACE_THREAD_NAME(name) \
+  ::engine::core::Trace::SetThreadName(name)
+#else
+#define ENGINE_TRACE_SCOPE(name) static_cast<void>(0)
+#define ENGINE_TRACE_RECORD(name, start_ns, end_ns) static_cast<void>(0)
+#define ENGINE_TRACE_THREAD_NAME(name) static_cast<void>(0)
+#endif
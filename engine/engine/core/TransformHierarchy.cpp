@@ -0,0 +1,415 @@
+#include "TransformHierarchy.h"
+
+#include <algorithm>
+
+#include "TransformKernel.h"
+
+namespace engine::core {
+namespace {
+glm::mat4 ComposeLocal(TransformStore const& store, TransformHandle handle) {
+  const glm::vec3 position = store.position(handle);
+  const glm::quat rotation = store.rotation(handle);
+  const glm::vec3 scale = store.scale(handle);
+  glm::mat4 local;
+  TransformKernel::Compose({&position.x, &position.y, &position.z, &rotation.x,
+                            &rotation.y, &rotation.z, &rotation.w, &scale.x,
+                            &scale.y, &scale.z},
+                           1, &local);
+  return local;
+}
+}  // namespace
+
+TransformHierarchy& TransformHierarchy::Global() {
+  static TransformHierarchy hierarchy(TransformStore::Global());
+  return hierarchy;
+}
+
+NodeHandle TransformHierarchy::Add(TransformHandle transform,
+                                   NodeHandle parent) {
+  NodeHandle node;
+  {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    if (parent.valid() && !valid(parent)) {
+      return {};
+    }
+    uint32_t index = 0;
+    if (!free_slots_.empty()) {
+      index = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      if (next_slot_ == kPageSize * kMaxPages) {
+        return {};
+      }
+      index = next_slot_++;
+      next_generation_.push_back(1);
+      if (index / kPageSize == page_count_.load(std::memory_order_relaxed)) {
+        pages_[index / kPageSize] = std::make_unique<Page>();
+        page_count_.fetch_add(1, std::memory_order_release);
+      }
+    }
+    node = {index, next_generation_[index]++};
+    if (next_generation_[index] == 0) {  // zero is never used
+      next_generation_[index] = 1;
+    }
+    Page& p = page(index);
+    const uint32_t slot = index % kPageSize;
+    p.transform[slot] = transform;
+    p.first_child[slot] = kNone;
+    p.position[slot] = kNone;
+    Link(index, parent.valid() ? parent.index : kNone);
+    p.generation[slot].store(node.generation, std::memory_order_release);
+    order_changed_ = true;
+  }
+  size_.fetch_add(1, std::memory_order_relaxed);
+  MarkDirty(node);
+  return node;
+}
+
+void TransformHierarchy::Remove(NodeHandle node) {
+  std::scoped_lock<std::mutex> lock(mutex_);
+  if (!valid(node)) {
+    return;
+  }
+  Page& p = page(node.index);
+  const uint32_t slot = node.index % kPageSize;
+  const uint32_t parent = p.parent[slot];
+  while (p.first_child[slot] != kNone) {
+    const uint32_t child = p.first_child[slot];
+    Unlink(child);
+    Link(child, parent);
+    Page& child_page = page(child);
+    MarkDirty({child, child_page.generation[child % kPageSize].load(
+                          std::memory_order_relaxed)});
+  }
+  Unlink(node.index);
+  // the flag stays set if the slot is dirty, the propagation skips it
+  p.generation[slot].store(0, std::memory_order_relaxed);
+  free_slots_.push_back(node.index);
+  size_.fetch_sub(1, std::memory_order_relaxed);
+  order_changed_ = true;
+}
+
+bool TransformHierarchy::SetParent(NodeHandle node, NodeHandle parent) {
+  {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    if (!valid(node) || (parent.valid() && !valid(parent))) {
+      return false;
+    }
+    const uint32_t new_parent = parent.valid() ? parent.index : kNone;
+    for (uint32_t ancestor = new_parent; ancestor != kNone;
+         ancestor = page(ancestor).parent[ancestor % kPageSize]) {
+      if (ancestor == node.index) {
+        return false;
+      }
+    }
+    if (page(node.index).parent[node.index % kPageSize] == new_parent) {
+      return true;
+    }
+    Unlink(node.index);
+    Link(node.index, new_parent);
+    order_changed_ = true;
+  }
+  MarkDirty(node);
+  return true;
+}
+
+bool TransformHierarchy::valid(NodeHandle node) const noexcept {
+  if (!node.valid() ||
+      node.index / kPageSize >= page_count_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  return page(node.index)
+             .generation[node.index % kPageSize]
+             .load(std::memory_order_acquire) == node.generation;
+}
+
+NodeHandle TransformHierarchy::parent(NodeHandle node) const {
+  std::scoped_lock<std::mutex> lock(mutex_);
+  if (!valid(node)) {
+    return {};
+  }
+  const uint32_t parent = page(node.index).parent[node.index % kPageSize];
+  if (parent == kNone) {
+    return {};
+  }
+  return {parent, page(parent).generation[parent % kPageSize].load(
+                      std::memory_order_relaxed)};
+}
+
+void TransformHierarchy::MarkDirty(NodeHandle node) noexcept {
+  if (!valid(node)) {
+    return;
+  }
+  // the first mark since the last propagation queues the slot, the
+  // exchange also publishes the new transform to the propagation
+  if (!page(node.index)
+           .dirty[node.index % kPageSize]
+           .exchange(true, std::memory_order_acq_rel)) {
+    std::scoped_lock<std::mutex> lock(dirty_mutex_);
+    dirty_slots_.push_back(node.index);
+  }
+}
+
+glm::mat4 TransformHierarchy::world_matrix(NodeHandle node) const {
+  if (!valid(node)) {
+    return glm::mat4(1.0F);
+  }
+  Page const& p = page(node.index);
+  const uint32_t slot = node.index % kPageSize;
+  if (p.position[slot] == kNone) {
+    return ComposeLocal(store_, p.transform[slot]);
+  }
+  return world_[p.position[slot]];
+}
+
+void TransformHierarchy::Link(uint32_t index, uint32_t parent) noexcept {
+  Page& p = page(index);
+  const uint32_t slot = index % kPageSize;
+  p.parent[slot] = parent;
+  p.previous_sibling[slot] = kNone;
+  p.next_sibling[slot] = kNone;
+  if (parent == kNone) {
+    return;
+  }
+  uint32_t& first = page(parent).first_child[parent % kPageSize];
+  if (first != kNone) {
+    page(first).previous_sibling[first % kPageSize] = index;
+    p.next_sibling[slot] = first;
+  }
+  first = index;
+}
+
+void TransformHierarchy::Unlink(uint32_t index) noexcept {
+  Page& p = page(index);
+  const uint32_t slot = index % kPageSize;
+  const uint32_t previous = p.previous_sibling[slot];
+  const uint32_t next = p.next_sibling[slot];
+  if (next != kNone) {
+    page(next).previous_sibling[next % kPageSize] = previous;
+  }
+  if (previous != kNone) {
+    page(previous).next_sibling[previous % kPageSize] = next;
+  } else if (p.parent[slot] != kNone) {
+    page(p.parent[slot]).first_child[p.parent[slot] % kPageSize] = next;
+  }
+  p.parent[slot] = kNone;
+  p.previous_sibling[slot] = kNone;
+  p.next_sibling[slot] = kNone;
+}
+
+void TransformHierarchy::RebuildOrder() {
+  const size_t count = size_.load(std::memory_order_relaxed);
+  std::vector<uint32_t> slots;
+  slots.reserve(count);
+  std::vector<uint32_t> child_begin;
+  std::vector<uint32_t> child_end;
+  child_begin.reserve(count);
+  child_end.reserve(count);
+  for (uint32_t index = 0; index < next_slot_; index++) {
+    Page const& p = page(index);
+    const uint32_t slot = index % kPageSize;
+    if (p.generation[slot].load(std::memory_order_relaxed) != 0 &&
+        p.parent[slot] == kNone) {
+      slots.push_back(index);
+    }
+  }
+  // children of a node follow the children of the nodes before it
+  for (size_t position = 0; position < slots.size(); position++) {
+    Page const& p = page(slots[position]);
+    child_begin.push_back(uint32_t(slots.size()));
+    for (uint32_t child = p.first_child[slots[position] % kPageSize];
+         child != kNone; child = page(child).next_sibling[child % kPageSize]) {
+      slots.push_back(child);
+    }
+    child_end.push_back(uint32_t(slots.size()));
+  }
+
+  // world matrices of the nodes which aren't dirty stay valid
+  std::vector<glm::mat4> world(slots.size(), glm::mat4(1.0F));
+  for (size_t position = 0; position < slots.size(); position++) {
+    Page& p = page(slots[position]);
+    const uint32_t slot = slots[position] % kPageSize;
+    if (p.position[slot] != kNone) {
+      world[position] = world_[p.position[slot]];
+    }
+  }
+  transform_.resize(slots.size());
+  parent_position_.resize(slots.size());
+  depth_.resize(slots.size());
+  for (size_t position = 0; position < slots.size(); position++) {
+    Page& p = page(slots[position]);
+    const uint32_t slot = slots[position] % kPageSize;
+    p.position[slot] = uint32_t(position);
+    transform_[position] = p.transform[slot];
+    // parents precede their children
+    const uint32_t parent = p.parent[slot];
+    parent_position_[position] =
+        parent == kNone ? kNone : page(parent).position[parent % kPageSize];
+    depth_[position] =
+        parent == kNone ? 0 : depth_[parent_position_[position]] + 1;
+  }
+  slot_ = std::move(slots);
+  child_begin_ = std::move(child_begin);
+  child_end_ = std::move(child_end);
+  world_ = std::move(world);
+  root_mark_.assign(slot_.size(), 0);
+  order_changed_ = false;
+}
+
+void TransformHierarchy::CollectDirtyRoots() {
+  {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    if (order_changed_) {
+      RebuildOrder();
+    }
+  }
+  collected_.clear();
+  {
+    std::scoped_lock<std::mutex> lock(dirty_mutex_);
+    collected_.swap(dirty_slots_);
+  }
+  roots_.clear();
+  for (uint32_t index : collected_) {
+    Page& p = page(index);
+    const uint32_t slot = index % kPageSize;
+    // cleared before the transform is read, so a later change is queued
+    // again
+    p.dirty[slot].exchange(false, std::memory_order_acq_rel);
+    if (p.generation[slot].load(std::memory_order_relaxed) == 0) {
+      continue;
+    }
+    const uint32_t position = p.position[slot];
+    if (root_mark_[position] == 0) {
+      root_mark_[position] = 1;
+      roots_.push_back(position);
+    }
+  }
+  std::sort(roots_.begin(), roots_.end());
+  // subtrees of dirty nodes include their dirty descendants
+  auto has_dirty_ancestor = [this](uint32_t position) {
+    for (uint32_t ancestor = parent_position_[position]; ancestor != kNone;
+         ancestor = parent_position_[ancestor]) {
+      if (root_mark_[ancestor] != 0) {
+        return true;
+      }
+    }
+    return false;
+  };
+  // the check reads the marks, so the covered roots are only flagged first;
+  // then every mark is cleared, including those of the dropped roots
+  constexpr uint8_t kCovered = 2;
+  for (uint32_t position : roots_) {
+    if (has_dirty_ancestor(position)) {
+      root_mark_[position] = kCovered;
+    }
+  }
+  size_t kept = 0;
+  for (uint32_t position : roots_) {
+    const bool covered = root_mark_[position] == kCovered;
+    root_mark_[position] = 0;
+    if (!covered) {
+      roots_[kept++] = position;
+    }
+  }
+  roots_.resize(kept);
+}
+
+void TransformHierarchy::ComposeWorld(uint32_t begin, uint32_t end) noexcept {
+  float components[10][kBlockSize];
+  glm::mat4 local[kBlockSize];
+  for (uint32_t block = begin; block < end; block += kBlockSize) {
+    const uint32_t count = std::min(kBlockSize, end - block);
+    for (uint32_t i = 0; i < count; i++) {
+      const TransformHandle handle = transform_[block + i];
+      const glm::vec3 position = store_.position(handle);
+      const glm::quat rotation = store_.rotation(handle);
+      const glm::vec3 scale = store_.scale(handle);
+      components[0][i] = position.x;
+      components[1][i] = position.y;
+      components[2][i] = position.z;
+      components[3][i] = rotation.x;
+      components[4][i] = rotation.y;
+      components[5][i] = rotation.z;
+      components[6][i] = rotation.w;
+      components[7][i] = scale.x;
+      components[8][i] = scale.y;
+      components[9][i] = scale.z;
+    }
+    TransformKernel::Compose(
+        {components[0], components[1], components[2], components[3],
+         components[4], components[5], components[6], components[7],
+         components[8], components[9]},
+        count, local);
+    for (uint32_t i = 0; i < count; i++) {
+      const uint32_t parent = parent_position_[block + i];
+      world_[block + i] =
+          parent == kNone ? local[i] : world_[parent] * local[i];
+    }
+  }
+}
+
+size_t TransformHierarchy::PropagateSubtree(uint32_t begin, uint32_t end,
+                                            bool split) {
+  size_t rebuilt = 0;
+  while (begin < end) {
+    if (split && end - begin >= kParallelWidth) {
+      for (uint32_t position = begin; position < end; position++) {
+        split_.push_back(position);
+      }
+      return rebuilt;
+    }
+    ComposeWorld(begin, end);
+    rebuilt += end - begin;
+    // children of the whole range are contiguous
+    const uint32_t next_begin = child_begin_[begin];
+    end = child_end_[end - 1];
+    begin = next_begin;
+  }
+  return rebuilt;
+}
+
+size_t TransformHierarchy::Propagate() {
+  CollectDirtyRoots();
+  size_t rebuilt = 0;
+  // consecutive dirty nodes of one depth, e.g. siblings, are one range
+  for (size_t i = 0; i < roots_.size();) {
+    size_t j = i + 1;
+    while (j < roots_.size() && roots_[j] == roots_[j - 1] + 1 &&
+           depth_[roots_[j]] == depth_[roots_[i]]) {
+      j++;
+    }
+    rebuilt += PropagateSubtree(roots_[i], roots_[j - 1] + 1, false);
+    i = j;
+  }
+  return rebuilt;
+}
+
+size_t TransformHierarchy::PrepareParallel() {
+  CollectDirtyRoots();
+  split_.clear();
+  for (size_t i = 0; i < roots_.size();) {
+    size_t j = i + 1;
+    while (j < roots_.size() && roots_[j] == roots_[j - 1] + 1 &&
+           depth_[roots_[j]] == depth_[roots_[i]]) {
+      j++;
+    }
+    PropagateSubtree(roots_[i], roots_[j - 1] + 1, true);
+    i = j;
+  }
+  return split_.size();
+}
+
+size_t TransformHierarchy::PropagateRange(size_t begin, size_t end) {
+  size_t rebuilt = 0;
+  for (size_t i = begin; i < end;) {
+    size_t j = i + 1;
+    while (j < end && split_[j] == split_[j - 1] + 1 &&
+           depth_[split_[j]] == depth_[split_[i]]) {
+      j++;
+    }
+    rebuilt += PropagateSubtree(split_[i], split_[j - 1] + 1, false);
+    i = j;
+  }
+  return rebuilt;
+}
+}  // namespace engine::core
@@ -0,0 +1,184 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "TransformStore.h"
+
+namespace engine::core {
+// Generational handle of a node in the TransformHierarchy, see
+// TransformHandle.
+struct NodeHandle {
+  uint32_t index = 0;
+  // zero generation is never used by a live node
+  uint32_t generation = 0;
+
+  [[nodiscard]] bool valid() const noexcept { return generation != 0; }
+  bool operator==(NodeHandle const&) const = default;
+};
+
+/// <summary>
+/// Parent/child relations of transforms. The world matrix of a node is the
+/// world matrix of its parent times the model matrix of its transform in the
+/// TransformStore, roots use the model matrix as is.
+///
+/// Nodes are kept in breadth-first order, so every depth is a contiguous
+/// range and the children of consecutive nodes of a depth are consecutive
+/// nodes of the next one. Only the subtrees of dirty nodes are propagated,
+/// depth by depth, so moving a node costs the size of its subtree, not of the
+/// scene. PrepareParallel stops at the first depth of a subtree which is at
+/// least kParallelWidth nodes wide and leaves the nodes of that depth to
+/// PropagateRange, each one with its whole subtree, so they can be split
+/// between threads, see HierarchyTicker.
+///
+/// Add, Remove and SetParent can be called from any thread except during the
+/// propagation, the order is rebuilt by the next propagation, which costs the
+/// size of the hierarchy. MarkDirty can be called from any thread at any
+/// time. world_matrix shouldn't be called during the propagation. The
+/// transform of a node should outlive the node.
+/// </summary>
+class TransformHierarchy {
+ public:
+  static constexpr uint32_t kPageSize = 1024;
+  static constexpr uint32_t kMaxPages = 4096;
+  // Subtrees are split between threads at the first depth with at least
+  // this many nodes.
+  static constexpr uint32_t kParallelWidth = 1024;
+
+  explicit TransformHierarchy(TransformStore& store) : store_(store) {}
+  ~TransformHierarchy() = default;
+
+  /* Disable copy and move semantics. */
+  TransformHierarchy(const TransformHierarchy&) = delete;
+  TransformHierarchy(TransformHierarchy&&) = delete;
+  TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+  TransformHierarchy& operator=(TransformHierarchy&&) = delete;
+
+  // Hierarchy of engine::core::Object, over TransformStore::Global().
+  [[nodiscard]] static TransformHierarchy& Global();
+
+  // Adds a dirty node for the transform, a root if the parent is invalid.
+  // Returns an invalid handle if the hierarchy is full or the parent is
+  // stale.
+  NodeHandle Add(TransformHandle transform, NodeHandle parent = {});
+  // Children of the node become children of its parent. Stale handles are
+  // ignored.
+  void Remove(NodeHandle node);
+  // Makes the node a root if the parent is invalid. Returns false if a
+  // handle is stale or the parent is in the subtree of the node.
+  bool SetParent(NodeHandle node, NodeHandle parent);
+
+  [[nodiscard]] bool valid(NodeHandle node) const noexcept;
+  // Invalid for roots and invalid nodes.
+  [[nodiscard]] NodeHandle parent(NodeHandle node) const;
+  // amount of live nodes
+  [[nodiscard]] size_t size() const noexcept {
+    return size_.load(std::memory_order_relaxed);
+  }
+
+  // The local transform has changed, the world matrices of the subtree are
+  // rebuilt by the next propagation. Stale handles are ignored.
+  void MarkDirty(NodeHandle node) noexcept;
+
+  // Matrix as of the last propagation, the model matrix of the transform if
+  // the node wasn't propagated yet, identity for invalid nodes.
+  [[nodiscard]] glm::mat4 world_matrix(NodeHandle node) const;
+
+  // Propagates every dirty subtree in the calling thread. Returns the amount
+  // of rebuilt world matrices.
+  size_t Propagate();
+
+  // Rebuilds the order if it has changed and propagates the dirty subtrees
+  // down to the depth where they are kParallelWidth wide. Returns the amount
+  // of nodes left for PropagateRange.
+  size_t PrepareParallel();
+  // Propagates the nodes [begin, end) left by PrepareParallel together with
+  // their subtrees. Can be called concurrently for disjoint ranges. Returns
+  // the amount of rebuilt world matrices.
+  size_t PropagateRange(size_t begin, size_t end);
+
+ private:
+  static constexpr uint32_t kNone = UINT32_MAX;
+  // nodes whose local matrices are composed at once
+  static constexpr uint32_t kBlockSize = 64;
+
+  struct Page {
+    // written under the mutex, zero if the slot is free
+    std::array<std::atomic<uint32_t>, kPageSize> generation{};
+    std::array<std::atomic<bool>, kPageSize> dirty{};
+    // written under the mutex
+    TransformHandle transform[kPageSize];
+    // slot indices or kNone, children are a doubly linked list
+    uint32_t parent[kPageSize];
+    uint32_t first_child[kPageSize];
+    uint32_t next_sibling[kPageSize];
+    uint32_t previous_sibling[kPageSize];
+    // position in the breadth-first arrays, kNone until the order is rebuilt
+    uint32_t position[kPageSize];
+  };
+
+  [[nodiscard]] Page& page(uint32_t index) const noexcept {
+    return *pages_[index / kPageSize];
+  }
+  // Called under the mutex.
+  void Link(uint32_t index, uint32_t parent) noexcept;
+  void Unlink(uint32_t index) noexcept;
+  // Moves the dirty nodes into roots_ and rebuilds the order if needed.
+  void CollectDirtyRoots();
+  void RebuildOrder();
+  // Rebuilds the world matrices of positions [begin, end), which have the
+  // same depth.
+  void ComposeWorld(uint32_t begin, uint32_t end) noexcept;
+  // Propagates the subtree of the positions [begin, end) of one depth,
+  // depth by depth. If split is set, stops at the first depth that is
+  // kParallelWidth wide and leaves it in split_. Returns the amount of
+  // rebuilt world matrices.
+  size_t PropagateSubtree(uint32_t begin, uint32_t end, bool split);
+
+  TransformStore& store_;
+
+  std::array<std::unique_ptr<Page>, kMaxPages> pages_;
+  std::atomic<uint32_t> page_count_ = 0;
+  std::atomic<size_t> size_ = 0;
+
+  // guards the slots and the structure
+  mutable std::mutex mutex_;
+  std::vector<uint32_t> free_slots_;
+  uint32_t next_slot_ = 0;
+  // generation of the next node in a slot, grows per slot
+  std::vector<uint32_t> next_generation_;
+  // set by the structural changes, cleared by RebuildOrder
+  bool order_changed_ = false;
+
+  // slots whose dirty flag was set, guarded by its own mutex so MarkDirty
+  // doesn't wait for the structural changes
+  std::mutex dirty_mutex_;
+  std::vector<uint32_t> dirty_slots_;
+
+  // Breadth-first arrays indexed by position, changed only by the
+  // propagation.
+  std::vector<uint32_t> slot_;
+  std::vector<TransformHandle> transform_;
+  std::vector<uint32_t> parent_position_;
+  std::vector<uint32_t> depth_;
+  // children of a node are [child_begin_, child_end_), for leaves both are
+  // the position where the children would be, so they never decrease
+  std::vector<uint32_t> child_begin_;
+  std::vector<uint32_t> child_end_;
+  std::vector<glm::mat4> world_;
+
+  // dirty_slots_ taken by the propagation
+  std::vector<uint32_t> collected_;
+  // positions of the dirty nodes without dirty ancestors, sorted
+  std::vector<uint32_t> roots_;
+  // marks positions of roots_ while they are collected
+  std::vector<uint8_t> root_mark_;
+  // see PrepareParallel
+  std::vector<uint32_t> split_;
+};
+}  // namespace engine::core
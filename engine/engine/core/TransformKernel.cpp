@@ -0,0 +1,414 @@
+#include "TransformKernel.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#define ENGINE_TRANSFORM_KERNEL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// Every path is compiled regardless of the compiler flags, the GCC and Clang
+// intrinsics need the instruction set on the function. MSVC allows them
+// anywhere.
+#if defined(__GNUC__)
+#define ENGINE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ENGINE_TARGET(isa)
+#endif
+
+namespace engine::core {
+namespace {
+void ComposeScalar(TransformArrays const& t, size_t count,
+                   glm::mat4* out) noexcept {
+  for (size_t i = 0; i < count; i++) {
+    const float x = t.rotation_x[i];
+    const float y = t.rotation_y[i];
+    const float z = t.rotation_z[i];
+    const float w = t.rotation_w[i];
+    const float x2 = x + x;
+    const float y2 = y + y;
+    const float z2 = z + z;
+    const float xx = x * x2;
+    const float yy = y * y2;
+    const float zz = z * z2;
+    const float xy = x * y2;
+    const float xz = x * z2;
+    const float yz = y * z2;
+    const float wx = w * x2;
+    const float wy = w * y2;
+    const float wz = w * z2;
+    const float sx = t.scale_x[i];
+    const float sy = t.scale_y[i];
+    const float sz = t.scale_z[i];
+    // columns of mat4_cast(rotation) scaled by the scale, the translation is
+    // the last column
+    glm::mat4& m = out[i];
+    m[0] = glm::vec4((1.0F - (yy + zz)) * sx, (xy + wz) * sx, (xz - wy) * sx,
+                     0.0F);
+    m[1] = glm::vec4((xy - wz) * sy, (1.0F - (xx + zz)) * sy, (yz + wx) * sy,
+                     0.0F);
+    m[2] = glm::vec4((xz + wy) * sz, (yz - wx) * sz, (1.0F - (xx + yy)) * sz,
+                     0.0F);
+    m[3] = glm::vec4(t.position_x[i], t.position_y[i], t.position_z[i], 1.0F);
+  }
+}
+
+#if defined(ENGINE_TRANSFORM_KERNEL_X86)
+// The SIMD paths compute every matrix element for N transforms in one
+// register, the same expressions as ComposeScalar, then transpose the
+// registers into matrices.
+
+ENGINE_TARGET("sse2")
+void ComposeSse(TransformArrays const& t, size_t count,
+                glm::mat4* out) noexcept {
+  const __m128 one = _mm_set1_ps(1.0F);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128 x = _mm_loadu_ps(t.rotation_x + i);
+    const __m128 y = _mm_loadu_ps(t.rotation_y + i);
+    const __m128 z = _mm_loadu_ps(t.rotation_z + i);
+    const __m128 w = _mm_loadu_ps(t.rotation_w + i);
+    const __m128 x2 = _mm_add_ps(x, x);
+    const __m128 y2 = _mm_add_ps(y, y);
+    const __m128 z2 = _mm_add_ps(z, z);
+    const __m128 xx = _mm_mul_ps(x, x2);
+    const __m128 yy = _mm_mul_ps(y, y2);
+    const __m128 zz = _mm_mul_ps(z, z2);
+    const __m128 xy = _mm_mul_ps(x, y2);
+    const __m128 xz = _mm_mul_ps(x, z2);
+    const __m128 yz = _mm_mul_ps(y, z2);
+    const __m128 wx = _mm_mul_ps(w, x2);
+    const __m128 wy = _mm_mul_ps(w, y2);
+    const __m128 wz = _mm_mul_ps(w, z2);
+    const __m128 sx = _mm_loadu_ps(t.scale_x + i);
+    const __m128 sy = _mm_loadu_ps(t.scale_y + i);
+    const __m128 sz = _mm_loadu_ps(t.scale_z + i);
+
+    __m128 c0[4] = {_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx),
+                    _mm_mul_ps(_mm_add_ps(xy, wz), sx),
+                    _mm_mul_ps(_mm_sub_ps(xz, wy), sx), _mm_setzero_ps()};
+    __m128 c1[4] = {_mm_mul_ps(_mm_sub_ps(xy, wz), sy),
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy),
+                    _mm_mul_ps(_mm_add_ps(yz, wx), sy), _mm_setzero_ps()};
+    __m128 c2[4] = {_mm_mul_ps(_mm_add_ps(xz, wy), sz),
+                    _mm_mul_ps(_mm_sub_ps(yz, wx), sz),
+                    _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz),
+                    _mm_setzero_ps()};
+    __m128 c3[4] = {_mm_loadu_ps(t.position_x + i),
+                    _mm_loadu_ps(t.position_y + i),
+                    _mm_loadu_ps(t.position_z + i), one};
+    _MM_TRANSPOSE4_PS(c0[0], c0[1], c0[2], c0[3]);
+    _MM_TRANSPOSE4_PS(c1[0], c1[1], c1[2], c1[3]);
+    _MM_TRANSPOSE4_PS(c2[0], c2[1], c2[2], c2[3]);
+    _MM_TRANSPOSE4_PS(c3[0], c3[1], c3[2], c3[3]);
+    float* matrices = &out[i][0][0];
+    for (size_t lane = 0; lane < 4; lane++) {
+      float* m = matrices + lane * 16;
+      _mm_storeu_ps(m, c0[lane]);
+      _mm_storeu_ps(m + 4, c1[lane]);
+      _mm_storeu_ps(m + 8, c2[lane]);
+      _mm_storeu_ps(m + 12, c3[lane]);
+    }
+  }
+  ComposeScalar(
+      {t.position_x + i, t.position_y + i, t.position_z + i, t.rotation_x + i,
+       t.rotation_y + i, t.rotation_z + i, t.rotation_w + i, t.scale_x + i,
+       t.scale_y + i, t.scale_z + i},
+      count - i, out + i);
+}
+
+// Transposes 8 registers with element k of 8 matrices into 8 registers with
+// elements 0..7 of one matrix and stores them at offset floats of the
+// matrices.
+ENGINE_TARGET("avx2")
+inline void TransposeStore8(__m256 (&e)[8], float* matrices,
+                            size_t offset) noexcept {
+  const __m256 t0 = _mm256_unpacklo_ps(e[0], e[1]);
+  const __m256 t1 = _mm256_unpackhi_ps(e[0], e[1]);
+  const __m256 t2 = _mm256_unpacklo_ps(e[2], e[3]);
+  const __m256 t3 = _mm256_unpackhi_ps(e[2], e[3]);
+  const __m256 t4 = _mm256_unpacklo_ps(e[4], e[5]);
+  const __m256 t5 = _mm256_unpackhi_ps(e[4], e[5]);
+  const __m256 t6 = _mm256_unpacklo_ps(e[6], e[7]);
+  const __m256 t7 = _mm256_unpackhi_ps(e[6], e[7]);
+  const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+  float* m = matrices + offset;
+  _mm256_storeu_ps(m + 0 * 16, _mm256_permute2f128_ps(s0, s4, 0x20));
+  _mm256_storeu_ps(m + 1 * 16, _mm256_permute2f128_ps(s1, s5, 0x20));
+  _mm256_storeu_ps(m + 2 * 16, _mm256_permute2f128_ps(s2, s6, 0x20));
+  _mm256_storeu_ps(m + 3 * 16, _mm256_permute2f128_ps(s3, s7, 0x20));
+  _mm256_storeu_ps(m + 4 * 16, _mm256_permute2f128_ps(s0, s4, 0x31));
+  _mm256_storeu_ps(m + 5 * 16, _mm256_permute2f128_ps(s1, s5, 0x31));
+  _mm256_storeu_ps(m + 6 * 16, _mm256_permute2f128_ps(s2, s6, 0x31));
+  _mm256_storeu_ps(m + 7 * 16, _mm256_permute2f128_ps(s3, s7, 0x31));
+}
+
+ENGINE_TARGET("avx2")
+void ComposeAvx2(TransformArrays const& t, size_t count,
+                 glm::mat4* out) noexcept {
+  const __m256 one = _mm256_set1_ps(1.0F);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 x = _mm256_loadu_ps(t.rotation_x + i);
+    const __m256 y = _mm256_loadu_ps(t.rotation_y + i);
+    const __m256 z = _mm256_loadu_ps(t.rotation_z + i);
+    const __m256 w = _mm256_loadu_ps(t.rotation_w + i);
+    const __m256 x2 = _mm256_add_ps(x, x);
+    const __m256 y2 = _mm256_add_ps(y, y);
+    const __m256 z2 = _mm256_add_ps(z, z);
+    const __m256 xx = _mm256_mul_ps(x, x2);
+    const __m256 yy = _mm256_mul_ps(y, y2);
+    const __m256 zz = _mm256_mul_ps(z, z2);
+    const __m256 xy = _mm256_mul_ps(x, y2);
+    const __m256 xz = _mm256_mul_ps(x, z2);
+    const __m256 yz = _mm256_mul_ps(y, z2);
+    const __m256 wx = _mm256_mul_ps(w, x2);
+    const __m256 wy = _mm256_mul_ps(w, y2);
+    const __m256 wz = _mm256_mul_ps(w, z2);
+    const __m256 sx = _mm256_loadu_ps(t.scale_x + i);
+    const __m256 sy = _mm256_loadu_ps(t.scale_y + i);
+    const __m256 sz = _mm256_loadu_ps(t.scale_z + i);
+    const __m256 zero = _mm256_setzero_ps();
+
+    // elements 0..7 are the columns 0 and 1, 8..15 the columns 2 and 3
+    __m256 low[8] = {
+        _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx),
+        _mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+        _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx),
+        zero,
+        _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy),
+        _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+        _mm256_mul_ps(_mm256_add_ps(yz, wx), sy),
+        zero};
+    __m256 high[8] = {
+        _mm256_mul_ps(_mm256_add_ps(xz, wy), sz),
+        _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+        _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz),
+        zero,
+        _mm256_loadu_ps(t.position_x + i),
+        _mm256_loadu_ps(t.position_y + i),
+        _mm256_loadu_ps(t.position_z + i),
+        one};
+    float* matrices = &out[i][0][0];
+    TransposeStore8(low, matrices, 0);
+    TransposeStore8(high, matrices, 8);
+  }
+  ComposeSse(
+      {t.position_x + i, t.position_y + i, t.position_z + i, t.rotation_x + i,
+       t.rotation_y + i, t.rotation_z + i, t.rotation_w + i, t.scale_x + i,
+       t.scale_y + i, t.scale_z + i},
+      count - i, out + i);
+}
+
+// Interleaves elements 4k..4k+3 of 16 transforms, s_m holds them for the
+// transforms m, 4 + m, 8 + m and 12 + m in its 128 bit lanes.
+ENGINE_TARGET("avx512f")
+inline void Interleave4(__m512 e0, __m512 e1, __m512 e2, __m512 e3,
+                        __m512 (&s)[4]) noexcept {
+  const __m512 t0 = _mm512_unpacklo_ps(e0, e1);
+  const __m512 t1 = _mm512_unpackhi_ps(e0, e1);
+  const __m512 t2 = _mm512_unpacklo_ps(e2, e3);
+  const __m512 t3 = _mm512_unpackhi_ps(e2, e3);
+  s[0] = _mm512_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  s[1] = _mm512_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  s[2] = _mm512_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  s[3] = _mm512_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+// Transposes the 128 bit lanes of the quads of transform m and stores the
+// whole matrices m, 4 + m, 8 + m and 12 + m.
+ENGINE_TARGET("avx512f")
+inline void StoreLanes(__m512 a, __m512 b, __m512 c, __m512 d,
+                       float* matrices) noexcept {
+  const __m512 ab0 = _mm512_shuffle_f32x4(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+  const __m512 ab1 = _mm512_shuffle_f32x4(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+  const __m512 cd0 = _mm512_shuffle_f32x4(c, d, _MM_SHUFFLE(2, 0, 2, 0));
+  const __m512 cd1 = _mm512_shuffle_f32x4(c, d, _MM_SHUFFLE(3, 1, 3, 1));
+  _mm512_storeu_ps(matrices,
+                   _mm512_shuffle_f32x4(ab0, cd0, _MM_SHUFFLE(2, 0, 2, 0)));
+  _mm512_storeu_ps(matrices + 4 * 16,
+                   _mm512_shuffle_f32x4(ab1, cd1, _MM_SHUFFLE(2, 0, 2, 0)));
+  _mm512_storeu_ps(matrices + 8 * 16,
+                   _mm512_shuffle_f32x4(ab0, cd0, _MM_SHUFFLE(3, 1, 3, 1)));
+  _mm512_storeu_ps(matrices + 12 * 16,
+                   _mm512_shuffle_f32x4(ab1, cd1, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+ENGINE_TARGET("avx512f")
+void ComposeAvx512(TransformArrays const& t, size_t count,
+                   glm::mat4* out) noexcept {
+  const __m512 one = _mm512_set1_ps(1.0F);
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m512 x = _mm512_loadu_ps(t.rotation_x + i);
+    const __m512 y = _mm512_loadu_ps(t.rotation_y + i);
+    const __m512 z = _mm512_loadu_ps(t.rotation_z + i);
+    const __m512 w = _mm512_loadu_ps(t.rotation_w + i);
+    const __m512 x2 = _mm512_add_ps(x, x);
+    const __m512 y2 = _mm512_add_ps(y, y);
+    const __m512 z2 = _mm512_add_ps(z, z);
+    const __m512 xx = _mm512_mul_ps(x, x2);
+    const __m512 yy = _mm512_mul_ps(y, y2);
+    const __m512 zz = _mm512_mul_ps(z, z2);
+    const __m512 xy = _mm512_mul_ps(x, y2);
+    const __m512 xz = _mm512_mul_ps(x, z2);
+    const __m512 yz = _mm512_mul_ps(y, z2);
+    const __m512 wx = _mm512_mul_ps(w, x2);
+    const __m512 wy = _mm512_mul_ps(w, y2);
+    const __m512 wz = _mm512_mul_ps(w, z2);
+    const __m512 sx = _mm512_loadu_ps(t.scale_x + i);
+    const __m512 sy = _mm512_loadu_ps(t.scale_y + i);
+    const __m512 sz = _mm512_loadu_ps(t.scale_z + i);
+    const __m512 zero = _mm512_setzero_ps();
+
+    // a whole matrix is one register, so the 16 element registers are
+    // transposed into 16 matrices
+    __m512 column0[4];
+    __m512 column1[4];
+    __m512 column2[4];
+    __m512 column3[4];
+    Interleave4(_mm512_mul_ps(_mm512_sub_ps(one, _mm512_add_ps(yy, zz)), sx),
+                _mm512_mul_ps(_mm512_add_ps(xy, wz), sx),
+                _mm512_mul_ps(_mm512_sub_ps(xz, wy), sx), zero, column0);
+    Interleave4(_mm512_mul_ps(_mm512_sub_ps(xy, wz), sy),
+                _mm512_mul_ps(_mm512_sub_ps(one, _mm512_add_ps(xx, zz)), sy),
+                _mm512_mul_ps(_mm512_add_ps(yz, wx), sy), zero, column1);
+    Interleave4(_mm512_mul_ps(_mm512_add_ps(xz, wy), sz),
+                _mm512_mul_ps(_mm512_sub_ps(yz, wx), sz),
+                _mm512_mul_ps(_mm512_sub_ps(one, _mm512_add_ps(xx, yy)), sz),
+                zero, column2);
+    Interleave4(_mm512_loadu_ps(t.position_x + i),
+                _mm512_loadu_ps(t.position_y + i),
+                _mm512_loadu_ps(t.position_z + i), one, column3);
+    float* matrices = &out[i][0][0];
+    StoreLanes(column0[0], column1[0], column2[0], column3[0], matrices);
+    StoreLanes(column0[1], column1[1], column2[1], column3[1], matrices + 16);
+    StoreLanes(column0[2], column1[2], column2[2], column3[2], matrices + 32);
+    StoreLanes(column0[3], column1[3], column2[3], column3[3], matrices + 48);
+  }
+  ComposeAvx2(
+      {t.position_x + i, t.position_y + i, t.position_z + i, t.rotation_x + i,
+       t.rotation_y + i, t.rotation_z + i, t.rotation_w + i, t.scale_x + i,
+       t.scale_y + i, t.scale_z + i},
+      count - i, out + i);
+}
+
+SimdLevel DetectLevel() noexcept {
+#if defined(_MSC_VER)
+  int regs[4] = {};
+  __cpuid(regs, 0);
+  const int max_leaf = regs[0];
+  __cpuid(regs, 1);
+  const bool sse2 = (regs[3] & (1 << 26)) != 0;
+  const bool osxsave = (regs[2] & (1 << 27)) != 0;
+  const bool avx = (regs[2] & (1 << 28)) != 0;
+  // the OS saves the registers on context switches
+  const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+  bool avx2 = false;
+  bool avx512 = false;
+  if (max_leaf >= 7) {
+    __cpuidex(regs, 7, 0);
+    avx2 = avx && (xcr0 & 0x6) == 0x6 && (regs[1] & (1 << 5)) != 0;
+    avx512 = avx2 && (xcr0 & 0xE6) == 0xE6 && (regs[1] & (1 << 16)) != 0;
+  }
+#else
+  // checks the OS support as well
+  __builtin_cpu_init();
+  const bool sse2 = __builtin_cpu_supports("sse2");
+  const bool avx2 = __builtin_cpu_supports("avx2");
+  const bool avx512 = avx2 && __builtin_cpu_supports("avx512f");
+#endif
+  if (avx512) {
+    return SimdLevel::kAvx512;
+  }
+  if (avx2) {
+    return SimdLevel::kAvx2;
+  }
+  return sse2 ? SimdLevel::kSse : SimdLevel::kScalar;
+}
+#else
+SimdLevel DetectLevel() noexcept { return SimdLevel::kScalar; }
+#endif
+
+TransformKernel::Function FunctionOf(SimdLevel level) noexcept {
+  switch (level) {
+#if defined(ENGINE_TRANSFORM_KERNEL_X86)
+    case SimdLevel::kAvx512:
+      return ComposeAvx512;
+    case SimdLevel::kAvx2:
+      return ComposeAvx2;
+    case SimdLevel::kSse:
+      return ComposeSse;
+#endif
+    default:
+      return ComposeScalar;
+  }
+}
+
+SimdLevel DefaultLevel() noexcept {
+  return std::min(TransformKernel::supported_level(), SimdLevel::kAvx2);
+}
+
+std::atomic<TransformKernel::Function>& ActiveFunction() noexcept {
+  static std::atomic<TransformKernel::Function> function =
+      FunctionOf(DefaultLevel());
+  return function;
+}
+std::atomic<SimdLevel>& ActiveLevel() noexcept {
+  static std::atomic<SimdLevel> level = DefaultLevel();
+  return level;
+}
+}  // namespace
+
+SimdLevel TransformKernel::supported_level() noexcept {
+  static const SimdLevel level = DetectLevel();
+  return level;
+}
+
+SimdLevel TransformKernel::level() noexcept {
+  return ActiveLevel().load(std::memory_order_relaxed);
+}
+
+bool TransformKernel::SetLevel(SimdLevel level) noexcept {
+  if (level > supported_level()) {
+    return false;
+  }
+  ActiveLevel().store(level, std::memory_order_relaxed);
+  ActiveFunction().store(FunctionOf(level), std::memory_order_relaxed);
+  return true;
+}
+
+TransformKernel::Function TransformKernel::function(SimdLevel level) noexcept {
+  return level > supported_level() ? nullptr : FunctionOf(level);
+}
+
+const char* TransformKernel::name(SimdLevel level) noexcept {
+  switch (level) {
+    case SimdLevel::kSse:
+      return "sse";
+    case SimdLevel::kAvx2:
+      return "avx2";
+    case SimdLevel::kAvx512:
+      return "avx512";
+    default:
+      return "scalar";
+  }
+}
+
+void TransformKernel::Compose(TransformArrays const& transforms, size_t count,
+                              glm::mat4* out) noexcept {
+  ActiveFunction().load(std::memory_order_relaxed)(transforms, count, out);
+}
+}  // namespace engine::core
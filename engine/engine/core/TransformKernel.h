@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace engine::core {
+// Instruction sets of TransformKernel, from the slowest to the fastest.
+enum class SimdLevel : uint8_t { kScalar, kSse, kAvx2, kAvx512 };
+
+// Components of consecutive transforms, one array per component like in
+// TransformStore. The rotation should be a normalised quaternion.
+struct TransformArrays {
+  const float* position_x;
+  const float* position_y;
+  const float* position_z;
+  const float* rotation_x;
+  const float* rotation_y;
+  const float* rotation_z;
+  const float* rotation_w;
+  const float* scale_x;
+  const float* scale_y;
+  const float* scale_z;
+};
+
+/// <summary>
+/// Builds model matrices, translate * mat4_cast(rotation) * scale, straight
+/// from the components instead of multiplying three matrices.
+/// Each SIMD path computes 4, 8 or 16 transforms at once from the component
+/// arrays and transposes the results into glm::mat4 columns, the rest is
+/// done by the scalar path. The path is chosen once by the instruction sets
+/// the CPU and the OS support, every path is compiled into the same binary.
+/// AVX2 is preferred over AVX-512: writing the matrices limits both, and the
+/// extra lane shuffles of the 16 wide transposition made it slower, see
+/// bench/TransformBench.cpp.
+/// </summary>
+class TransformKernel {
+ public:
+  using Function = void (*)(TransformArrays const& transforms, size_t count,
+                            glm::mat4* out) noexcept;
+
+  // The fastest level the CPU supports, kScalar on other architectures.
+  [[nodiscard]] static SimdLevel supported_level() noexcept;
+
+  // Level used by Compose, at most kAvx2 unless it was set.
+  [[nodiscard]] static SimdLevel level() noexcept;
+
+  // Changes the level used by Compose, e.g. to compare the paths. Returns
+  // false if the CPU doesn't support the level.
+  static bool SetLevel(SimdLevel level) noexcept;
+
+  // Returns nullptr if the CPU doesn't support the level.
+  [[nodiscard]] static Function function(SimdLevel level) noexcept;
+
+  [[nodiscard]] static const char* name(SimdLevel level) noexcept;
+
+  // Writes count matrices into out.
+  static void Compose(TransformArrays const& transforms, size_t count,
+                      glm::mat4* out) noexcept;
+};
+}  // namespace engine::core
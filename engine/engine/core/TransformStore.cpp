@@ -0,0 +1,194 @@
+#include "TransformStore.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "TransformKernel.h"
+
+namespace engine::core {
+TransformStore& TransformStore::Global() {
+  static TransformStore store;
+  return store;
+}
+
+TransformHandle TransformStore::Add(glm::vec3 const& position,
+                                    glm::quat const& rotation,
+                                    glm::vec3 const& scale) {
+  uint32_t index = 0;
+  uint32_t generation = 0;
+  {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    if (!free_slots_.empty()) {
+      index = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      if (next_slot_ == kPageSize * kMaxPages) {
+        return {};
+      }
+      index = next_slot_++;
+      next_generation_.push_back(1);
+      if (index / kPageSize == page_count_.load(std::memory_order_relaxed)) {
+        pages_[index / kPageSize] = std::make_unique<Page>();
+        page_count_.fetch_add(1, std::memory_order_release);
+      }
+    }
+    generation = next_generation_[index]++;
+    if (next_generation_[index] == 0) {  // zero is never used
+      next_generation_[index] = 1;
+    }
+  }
+  const TransformHandle handle{index, generation};
+  SetPosition(handle, position);
+  SetRotation(handle, rotation);
+  SetScale(handle, scale);
+  page(index).generation[index % kPageSize].store(generation,
+                                                  std::memory_order_release);
+  size_.fetch_add(1, std::memory_order_relaxed);
+  return handle;
+}
+
+void TransformStore::Remove(TransformHandle handle) {
+  std::scoped_lock<std::mutex> lock(mutex_);
+  if (!valid(handle)) {
+    return;
+  }
+  Page& p = page(handle.index);
+  const uint32_t slot = handle.index % kPageSize;
+  p.generation[slot].store(0, std::memory_order_relaxed);
+  // free slots are never rebuilt
+  p.dirty[slot / kWordBits].fetch_and(~(uint64_t(1) << (slot % kWordBits)),
+                                      std::memory_order_relaxed);
+  free_slots_.push_back(handle.index);
+  size_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool TransformStore::valid(TransformHandle handle) const noexcept {
+  if (!handle.valid() || handle.index / kPageSize >= page_count()) {
+    return false;
+  }
+  return page(handle.index)
+             .generation[handle.index % kPageSize]
+             .load(std::memory_order_acquire) == handle.generation;
+}
+
+glm::vec3 TransformStore::position(TransformHandle handle) const noexcept {
+  Page const& p = page(handle.index);
+  const uint32_t slot = handle.index % kPageSize;
+  return {p.position_x[slot], p.position_y[slot], p.position_z[slot]};
+}
+
+glm::quat TransformStore::rotation(TransformHandle handle) const noexcept {
+  Page const& p = page(handle.index);
+  const uint32_t slot = handle.index % kPageSize;
+  return {p.rotation_w[slot], p.rotation_x[slot], p.rotation_y[slot],
+          p.rotation_z[slot]};
+}
+
+glm::vec3 TransformStore::scale(TransformHandle handle) const noexcept {
+  Page const& p = page(handle.index);
+  const uint32_t slot = handle.index % kPageSize;
+  return {p.scale_x[slot], p.scale_y[slot], p.scale_z[slot]};
+}
+
+void TransformStore::SetPosition(TransformHandle handle,
+                                 glm::vec3 const& position) noexcept {
+  Page& p = page(handle.index);
+  const uint32_t slot = handle.index % kPageSize;
+  p.position_x[slot] = position.x;
+  p.position_y[slot] = position.y;
+  p.position_z[slot] = position.z;
+  MarkDirty(handle.index);
+}
+
+void TransformStore::SetRotation(TransformHandle handle,
+                                 glm::quat const& rotation) noexcept {
+  Page& p = page(handle.index);
+  const uint32_t slot = handle.index % kPageSize;
+  p.rotation_x[slot] = rotation.x;
+  p.rotation_y[slot] = rotation.y;
+  p.rotation_z[slot] = rotation.z;
+  p.rotation_w[slot] = rotation.w;
+  MarkDirty(handle.index);
+}
+
+void TransformStore::SetScale(TransformHandle handle,
+                              glm::vec3 const& scale) noexcept {
+  Page& p = page(handle.index);
+  const uint32_t slot = handle.index % kPageSize;
+  p.scale_x[slot] = scale.x;
+  p.scale_y[slot] = scale.y;
+  p.scale_z[slot] = scale.z;
+  MarkDirty(handle.index);
+}
+
+bool TransformStore::dirty(TransformHandle handle) const noexcept {
+  const uint32_t slot = handle.index % kPageSize;
+  return (page(handle.index).dirty[slot / kWordBits].load(
+              std::memory_order_relaxed) &
+          (uint64_t(1) << (slot % kWordBits))) != 0;
+}
+
+glm::mat4 const& TransformStore::model_matrix(
+    TransformHandle handle) const noexcept {
+  return page(handle.index).model[handle.index % kPageSize];
+}
+
+void TransformStore::MarkDirty(uint32_t index) noexcept {
+  const uint32_t slot = index % kPageSize;
+  auto& word = page(index).dirty[slot / kWordBits];
+  const uint64_t bit = uint64_t(1) << (slot % kWordBits);
+  // an object which is moved every tick is usually dirty already, so the
+  // read-modify-write is skipped
+  if ((word.load(std::memory_order_relaxed) & bit) == 0) {
+    word.fetch_or(bit, std::memory_order_release);
+  }
+}
+
+void TransformStore::ComposeModels(Page& page, uint32_t first_slot,
+                                   uint32_t count) noexcept {
+  TransformKernel::Compose(
+      {page.position_x + first_slot, page.position_y + first_slot,
+       page.position_z + first_slot, page.rotation_x + first_slot,
+       page.rotation_y + first_slot, page.rotation_z + first_slot,
+       page.rotation_w + first_slot, page.scale_x + first_slot,
+       page.scale_y + first_slot, page.scale_z + first_slot},
+      count, page.model + first_slot);
+}
+
+void TransformStore::UpdateModelMatrix(TransformHandle handle) noexcept {
+  const uint32_t slot = handle.index % kPageSize;
+  Page& p = page(handle.index);
+  const uint64_t bit = uint64_t(1) << (slot % kWordBits);
+  if ((p.dirty[slot / kWordBits].fetch_and(~bit, std::memory_order_acquire) &
+       bit) != 0) {
+    ComposeModels(p, slot, 1);
+  }
+}
+
+size_t TransformStore::UpdateModelMatrices(uint32_t first_page,
+                                           uint32_t last_page) noexcept {
+  last_page = std::min(last_page, page_count());
+  size_t rebuilt = 0;
+  for (uint32_t i = first_page; i < last_page; i++) {
+    Page& p = *pages_[i];
+    for (uint32_t word = 0; word < p.dirty.size(); word++) {
+      // clean words cost one load
+      if (p.dirty[word].load(std::memory_order_relaxed) == 0) {
+        continue;
+      }
+      uint64_t bits = p.dirty[word].exchange(0, std::memory_order_acquire);
+      rebuilt += std::popcount(bits);
+      // runs of dirty transforms go through the SIMD kernel at once, clean
+      // ones in between may be written by other threads and aren't read
+      while (bits != 0) {
+        const uint32_t first = uint32_t(std::countr_zero(bits));
+        const uint32_t count = uint32_t(std::countr_one(bits >> first));
+        const uint32_t end = first + count;
+        bits = end == kWordBits ? 0 : bits & (~uint64_t(0) << end);
+        ComposeModels(p, word * kWordBits + first, count);
+      }
+    }
+  }
+  return rebuilt;
+}
+}  // namespace engine::core
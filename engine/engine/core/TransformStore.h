@@ -0,0 +1,140 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace engine::core {
+// Generational handle of a transform in the TransformStore, see
+// TickerHandle.
+struct TransformHandle {
+  uint32_t index = 0;
+  // zero generation is never used by a live transform
+  uint32_t generation = 0;
+
+  [[nodiscard]] bool valid() const noexcept { return generation != 0; }
+  bool operator==(TransformHandle const&) const = default;
+};
+
+/// <summary>
+/// Structure of arrays which stores position, rotation and scale of objects
+/// together with their cached model matrices.
+/// Every component is a separate array, so a pass over many transforms loads
+/// whole vectors of one component, and a dirty bit per transform tells which
+/// matrices should be rebuilt. Rebuilding the dirty ones is a single pass
+/// over the bitset, UpdateModelMatrices, instead of comparing matrices of
+/// every object.
+///
+/// Transforms live in pages which are never moved, so Add and Remove don't
+/// invalidate references and can be called from any thread while other
+/// transforms are read and written. A single transform shouldn't be written
+/// by two threads at once, like any other field of its object.
+/// Accessors don't check the generation, the handle should be valid.
+/// </summary>
+class TransformStore {
+ public:
+  // transforms per page, a multiple of the dirty word size
+  static constexpr uint32_t kPageSize = 1024;
+  static constexpr uint32_t kMaxPages = 4096;
+
+  TransformStore() = default;
+  ~TransformStore() = default;
+
+  /* Disable copy and move semantics. */
+  TransformStore(const TransformStore&) = delete;
+  TransformStore(TransformStore&&) = delete;
+  TransformStore& operator=(const TransformStore&) = delete;
+  TransformStore& operator=(TransformStore&&) = delete;
+
+  // Store of engine::core::Object.
+  [[nodiscard]] static TransformStore& Global();
+
+  // Returns an invalid handle if the store is full. The new transform is
+  // dirty.
+  TransformHandle Add(glm::vec3 const& position, glm::quat const& rotation,
+                      glm::vec3 const& scale);
+  // Stale handles are ignored.
+  void Remove(TransformHandle handle);
+
+  [[nodiscard]] bool valid(TransformHandle handle) const noexcept;
+  // amount of live transforms
+  [[nodiscard]] size_t size() const noexcept {
+    return size_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] uint32_t page_count() const noexcept {
+    return page_count_.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] glm::vec3 position(TransformHandle handle) const noexcept;
+  [[nodiscard]] glm::quat rotation(TransformHandle handle) const noexcept;
+  [[nodiscard]] glm::vec3 scale(TransformHandle handle) const noexcept;
+
+  // Setters mark the transform dirty.
+  void SetPosition(TransformHandle handle, glm::vec3 const& position) noexcept;
+  // The rotation should be normalised.
+  void SetRotation(TransformHandle handle, glm::quat const& rotation) noexcept;
+  void SetScale(TransformHandle handle, glm::vec3 const& scale) noexcept;
+
+  [[nodiscard]] bool dirty(TransformHandle handle) const noexcept;
+
+  // Matrix as of the last rebuild of the transform.
+  [[nodiscard]] glm::mat4 const& model_matrix(
+      TransformHandle handle) const noexcept;
+
+  // Rebuilds the matrix of one transform if it is dirty.
+  void UpdateModelMatrix(TransformHandle handle) noexcept;
+
+  // Rebuilds the dirty matrices of pages [first_page, last_page), so the
+  // pages can be split between threads. Returns the amount of rebuilt
+  // matrices.
+  size_t UpdateModelMatrices(uint32_t first_page, uint32_t last_page) noexcept;
+  size_t UpdateModelMatrices() noexcept {
+    return UpdateModelMatrices(0, page_count());
+  }
+
+ private:
+  static constexpr uint32_t kWordBits = 64;
+
+  struct Page {
+    alignas(64) float position_x[kPageSize];
+    alignas(64) float position_y[kPageSize];
+    alignas(64) float position_z[kPageSize];
+    alignas(64) float rotation_x[kPageSize];
+    alignas(64) float rotation_y[kPageSize];
+    alignas(64) float rotation_z[kPageSize];
+    alignas(64) float rotation_w[kPageSize];
+    alignas(64) float scale_x[kPageSize];
+    alignas(64) float scale_y[kPageSize];
+    alignas(64) float scale_z[kPageSize];
+    alignas(64) glm::mat4 model[kPageSize];
+    std::array<std::atomic<uint64_t>, kPageSize / kWordBits> dirty{};
+    // written under the mutex, zero if the slot is free
+    std::array<std::atomic<uint32_t>, kPageSize> generation{};
+  };
+
+  [[nodiscard]] Page& page(uint32_t index) const noexcept {
+    return *pages_[index / kPageSize];
+  }
+  void MarkDirty(uint32_t index) noexcept;
+  // Builds translation * rotation * scale of count slots.
+  static void ComposeModels(Page& page, uint32_t first_slot,
+                            uint32_t count) noexcept;
+
+  std::array<std::unique_ptr<Page>, kMaxPages> pages_;
+  // pages below the count are allocated and never change
+  std::atomic<uint32_t> page_count_ = 0;
+  std::atomic<size_t> size_ = 0;
+
+  // guards the slot allocation
+  std::mutex mutex_;
+  std::vector<uint32_t> free_slots_;
+  uint32_t next_slot_ = 0;
+  // generation of the next transform in a slot, grows per slot
+  std::vector<uint32_t> next_generation_;
+};
+}  // namespace engine::core
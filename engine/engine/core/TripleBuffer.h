@@ -0,0 +1,66 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace engine::core {
+/// <summary>
+/// Lock-free handoff of a value from one writer thread to one reader thread.
+/// The writer fills the back buffer and publishes it, the reader takes the
+/// latest published buffer as its front buffer. The published buffer waits
+/// in the middle slot, which is exchanged atomically by both sides, so
+/// neither side ever waits for the other: the writer overwrites a middle
+/// buffer the reader hasn't taken, and the reader keeps its front buffer if
+/// nothing new was published.
+/// Buffers are reused, the writer should overwrite everything it publishes.
+/// </summary>
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer() = default;
+  ~TripleBuffer() = default;
+
+  /* Disable copy and move semantics. */
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer(TripleBuffer&&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(TripleBuffer&&) = delete;
+
+  // Should be called only by the writer.
+  [[nodiscard]] T& back() noexcept { return buffers_[back_]; }
+  // Makes the back buffer the latest one, the writer continues with the
+  // buffer which was published before and not taken by the reader, or with
+  // the one the reader has released.
+  void Publish() noexcept {
+    back_ = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel) &
+            kIndexMask;
+  }
+
+  // Should be called only by the reader.
+  // Takes the latest published buffer as the front one. Returns false if
+  // nothing was published since the last call, the front buffer is kept.
+  bool Acquire() noexcept {
+    if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    return true;
+  }
+  // Should be called only by the reader, default constructed until the
+  // first Acquire which returned true.
+  [[nodiscard]] T const& front() const noexcept { return buffers_[front_]; }
+
+ private:
+  // set in middle_ while the middle buffer wasn't taken by the reader
+  static constexpr uint8_t kFresh = 4;
+  static constexpr uint8_t kIndexMask = 3;
+
+  std::array<T, 3> buffers_{};
+  // index of the middle buffer and kFresh
+  alignas(64) std::atomic<uint8_t> middle_ = 1;
+  // owned by the writer
+  alignas(64) uint8_t back_ = 0;
+  // owned by the reader
+  alignas(64) uint8_t front_ = 2;
+};
+}  // namespace engine::core
@@ -0,0 +1,101 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace engine::core {
+/// <summary>
+/// Bounded Chase-Lev work-stealing deque.
+/// The owning thread pushes and pops at the bottom, other threads steal from
+/// the top. The deque stores pointers only, the memory they point to should
+/// stay alive until the job is executed.
+/// </summary>
+template <typename T, size_t kCapacity = 4096>
+class WorkStealingDeque {
+  static_assert((kCapacity & (kCapacity - 1)) == 0,
+                "kCapacity should be a power of two");
+
+ public:
+  WorkStealingDeque() {
+    for (auto& item : buffer_) {
+      item.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  /* Disable copy and move semantics. */
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque(WorkStealingDeque&&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+  // Should be called only by the owning thread.
+  // Returns false if the deque is full, in that case the caller should execute
+  // the job by itself.
+  bool Push(T* item) noexcept {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_acquire);
+    if (bottom - top >= int64_t(kCapacity)) {
+      return false;
+    }
+    buffer_[bottom & kMask].store(item, std::memory_order_relaxed);
+    bottom_.store(bottom + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Should be called only by the owning thread.
+  // Returns nullptr if the deque is empty.
+  T* Pop() noexcept {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+
+    if (top > bottom) {  // deque was empty
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T* item = buffer_[bottom & kMask].load(std::memory_order_relaxed);
+    if (top == bottom) {  // last item, race against thieves
+      if (!top_.compare_exchange_strong(top, top + 1,
+                                        std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Can be called from any thread.
+  // Returns nullptr if the deque is empty or if we lost the race for the item.
+  T* Steal() noexcept {
+    int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return nullptr;
+    }
+    T* item = buffer_[top & kMask].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  // Approximate amount of items in the deque.
+  [[nodiscard]] size_t size() const noexcept {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_relaxed);
+    return bottom > top ? size_t(bottom - top) : 0;
+  }
+
+ private:
+  static constexpr int64_t kMask = int64_t(kCapacity) - 1;
+
+  alignas(64) std::atomic<int64_t> top_ = 0;
+  alignas(64) std::atomic<int64_t> bottom_ = 0;
+  alignas(64) std::array<std::atomic<T*>, kCapacity> buffer_;
+};
+}  // namespace engine::core
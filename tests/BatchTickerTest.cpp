@@ -0,0 +1,153 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "engine/BatchTicker.h"
+#include "engine/Core.h"
+
+using engine::core::BatchTicker;
+using engine::core::BatchTickerBase;
+using engine::core::Core;
+using engine::core::CoreConfig;
+
+namespace {
+CoreConfig ManualConfig(uint32_t threads) {
+  CoreConfig config;
+  config.threads = threads;
+  config.manual_ticks = true;
+  return config;
+}
+
+struct Item {
+  uint64_t added = 0;
+  uint64_t updates = 0;
+  uint64_t last_tick = 0;
+};
+
+// Counts the visits of every item and records the ranges of every tick.
+class CountingBatch : public BatchTicker<Item> {
+ public:
+  CountingBatch(size_t size, size_t grow, size_t grain)
+      : BatchTicker(1), grow_(grow) {
+    items().resize(size);
+    SetGrain(grain);
+  }
+
+  // [begin, end) of the chunks of the last tick, sorted
+  [[nodiscard]] std::vector<std::pair<size_t, size_t>> ranges() const {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    auto ranges = ranges_;
+    std::sort(ranges.begin(), ranges.end());
+    return ranges;
+  }
+  [[nodiscard]] uint64_t unprepared() const noexcept {
+    return unprepared_.load(std::memory_order_relaxed);
+  }
+
+ protected:
+  void PrepareBatch(const uint64_t tick) override {
+    prepared_tick_.store(tick, std::memory_order_relaxed);
+    for (size_t i = 0; i < grow_; i++) {
+      items().push_back({tick, 0, 0});
+    }
+    std::scoped_lock<std::mutex> lock(mutex_);
+    ranges_.clear();
+  }
+
+  void UpdateChunk(const uint64_t tick, std::span<Item> chunk) override {
+    // the jobs are pushed after PrepareBatch has returned
+    if (prepared_tick_.load(std::memory_order_relaxed) != tick) {
+      unprepared_.fetch_add(1, std::memory_order_relaxed);
+    }
+    for (Item& item : chunk) {
+      item.updates++;
+      item.last_tick = tick;
+    }
+    const size_t begin = size_t(chunk.data() - items().data());
+    std::scoped_lock<std::mutex> lock(mutex_);
+    ranges_.emplace_back(begin, begin + chunk.size());
+  }
+
+ private:
+  const size_t grow_;
+  std::atomic<uint64_t> prepared_tick_ = 0;
+  std::atomic<uint64_t> unprepared_ = 0;
+  mutable std::mutex mutex_;
+  std::vector<std::pair<size_t, size_t>> ranges_;
+};
+
+// Checks that the ranges cover [0, size) without gaps and overlaps.
+void ExpectCovers(std::vector<std::pair<size_t, size_t>> const& ranges,
+                  size_t size) {
+  size_t next = 0;
+  for (auto const& [begin, end] : ranges) {
+    EXPECT_EQ(begin, next);
+    EXPECT_LT(begin, end);
+    next = end;
+  }
+  EXPECT_EQ(next, size);
+}
+}  // namespace
+
+TEST(BatchTicker, VisitsEveryItemOncePerTick) {
+  auto core = Core::Create(ManualConfig(4));
+  // grows by one item in every PrepareBatch
+  auto batch = std::make_shared<CountingBatch>(10000, 1, 0);
+  ASSERT_EQ(core->AddTickingObject(batch), 1);
+  const uint64_t start = core->RunTicks(0);
+  const uint64_t last = core->RunTicks(50);
+  ASSERT_EQ(last, start + 50);
+
+  auto const& items = batch->items();
+  ASSERT_EQ(items.size(), 10050U);
+  for (size_t i = 0; i < items.size(); i++) {
+    // the original items since the first tick, the added ones since the
+    // tick which has added them
+    const uint64_t first = i < 10000 ? start + 1 : items[i].added;
+    ASSERT_EQ(items[i].updates, last - first + 1) << "item " << i;
+    ASSERT_EQ(items[i].last_tick, last) << "item " << i;
+  }
+  EXPECT_EQ(batch->unprepared(), 0U);
+
+  // the batch is split for the threads into aligned chunks
+  const auto ranges = batch->ranges();
+  EXPECT_GT(ranges.size(), 1U);
+  ExpectCovers(ranges, items.size());
+  for (size_t i = 0; i + 1 < ranges.size(); i++) {
+    const size_t size = ranges[i].second - ranges[i].first;
+    EXPECT_EQ(size % BatchTickerBase::kChunkAlignment, 0U);
+    EXPECT_GE(size, BatchTickerBase::kMinChunkSize);
+    EXPECT_EQ(size, ranges[0].second - ranges[0].first);
+  }
+}
+
+TEST(BatchTicker, ChunksAreNotSmallerThanTheFloor) {
+  auto core = Core::Create(ManualConfig(4));
+  // would be a few items per thread without the floor
+  const size_t size = BatchTickerBase::kMinChunkSize + 44;
+  auto batch = std::make_shared<CountingBatch>(size, 0, 0);
+  ASSERT_EQ(core->AddTickingObject(batch), 1);
+  core->RunTicks(2);
+  EXPECT_EQ(batch->ranges(),
+            (std::vector<std::pair<size_t, size_t>>{
+                {0, BatchTickerBase::kMinChunkSize},
+                {BatchTickerBase::kMinChunkSize, size}}));
+
+  // an explicit grain goes below it
+  auto fine = std::make_shared<CountingBatch>(100, 0, 10);
+  ASSERT_EQ(core->AddTickingObject(fine), 1);
+  core->RunTicks(2);
+  const auto ranges = fine->ranges();
+  EXPECT_EQ(ranges.size(), 10U);
+  ExpectCovers(ranges, 100);
+  for (auto const& item : fine->items()) {
+    EXPECT_EQ(item.updates, 2U);
+  }
+}
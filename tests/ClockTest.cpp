@@ -0,0 +1,20 @@
+#include "pch.h"
+
+#include <cstdint>
+
+#include "engine/core/Clock.h"
+
+using engine::core::Clock;
+
+TEST(Clock, SourceIsChosenOnce) {
+  const uint64_t before = Clock::now_ns();
+  const Clock::Source source = Clock::source();
+  // the clock is initialized, other threads may read it
+  for (const Clock::Source other :
+       {Clock::Source::kSteadyClock, Clock::Source::kMonotonicRaw,
+        Clock::Source::kTsc}) {
+    EXPECT_FALSE(Clock::SetSource(other));
+    EXPECT_EQ(Clock::source(), source);
+  }
+  EXPECT_GE(Clock::now_ns(), before);
+}
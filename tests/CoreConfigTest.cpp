@@ -0,0 +1,88 @@
+#include "pch.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include "engine/Core.h"
+#include "engine/core/CoreConfig.h"
+#include "engine/core/CpuTopology.h"
+
+using engine::core::Core;
+using engine::core::CoreConfig;
+using engine::core::CpuTopology;
+
+TEST(CoreConfig, ParsesCpuLists) {
+  std::vector<uint32_t> cpus;
+  ASSERT_TRUE(CoreConfig::ParseCpuList(" 4-6, 0,2 ,5", cpus));
+  EXPECT_EQ(cpus, (std::vector<uint32_t>{0, 2, 4, 5, 6}));
+  ASSERT_TRUE(CoreConfig::ParseCpuList("", cpus));
+  EXPECT_TRUE(cpus.empty());
+
+  cpus = {1};
+  EXPECT_FALSE(CoreConfig::ParseCpuList("3-1", cpus));
+  EXPECT_FALSE(CoreConfig::ParseCpuList("1,,2", cpus));
+  EXPECT_FALSE(CoreConfig::ParseCpuList("a", cpus));
+  EXPECT_FALSE(CoreConfig::ParseCpuList("0-100000", cpus));
+  // unchanged on failure
+  EXPECT_EQ(cpus, (std::vector<uint32_t>{1}));
+}
+
+TEST(CoreConfig, SetsKnownKeys) {
+  CoreConfig config;
+  EXPECT_TRUE(config.Set("threads", "6"));
+  EXPECT_TRUE(config.Set(" pin_threads ", "on"));
+  EXPECT_TRUE(config.Set("reserved_cpus", "0-1"));
+  EXPECT_TRUE(config.Set("numa_local", "true"));
+  EXPECT_EQ(config.threads, 6U);
+  EXPECT_TRUE(config.pin_threads);
+  EXPECT_EQ(config.reserved_cpus, (std::vector<uint32_t>{0, 1}));
+  EXPECT_TRUE(config.numa_local);
+
+  EXPECT_FALSE(config.Set("threads", "-1"));
+  EXPECT_FALSE(config.Set("pin_threads", "maybe"));
+  EXPECT_FALSE(config.Set("unknown", "1"));
+  EXPECT_EQ(config.threads, 6U);
+  EXPECT_TRUE(config.pin_threads);
+
+  EXPECT_EQ(config.tickrate, CoreConfig::kDefaultTickrate);
+  EXPECT_TRUE(config.Set("tickrate", "128"));
+  EXPECT_FALSE(config.Set("tickrate", "0"));
+  EXPECT_FALSE(config.Set("tickrate", "1000000"));
+  EXPECT_EQ(config.tickrate, 128U);
+}
+
+TEST(CoreConfig, LoadsFile) {
+  const char* path = "core_config_test.cfg";
+  {
+    std::ofstream file(path);
+    file << "# worker pool\n\nthreads = 3\nreserved_cpus=2\nbroken line\n";
+  }
+  CoreConfig config;
+  EXPECT_FALSE(config.LoadFile(path));
+  // valid lines are applied anyway
+  EXPECT_EQ(config.threads, 3U);
+  EXPECT_EQ(config.reserved_cpus, (std::vector<uint32_t>{2}));
+  std::remove(path);
+
+  EXPECT_FALSE(config.LoadFile("does_not_exist.cfg"));
+}
+
+TEST(CoreConfig, ReservedCpusNeedPinnedThreads) {
+  CoreConfig config;
+  config.threads = 2;
+  config.manual_ticks = true;
+  EXPECT_TRUE(config.Valid());
+  config.reserved_cpus = {0};
+  EXPECT_FALSE(config.Valid());
+  EXPECT_EQ(Core::Create(config), nullptr);
+  EXPECT_FALSE(Core::Configure(config));
+
+  config.pin_threads = true;
+  ASSERT_TRUE(config.Valid());
+  // only the update threads are pinned
+  const std::vector<uint32_t> affinity = CpuTopology::current_affinity();
+  auto core = Core::Create(config);
+  ASSERT_NE(core, nullptr);
+  core->RunTicks(1);
+  EXPECT_EQ(CpuTopology::current_affinity(), affinity);
+}
@@ -0,0 +1,170 @@
+#include "pch.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "engine/Core.h"
+
+using engine::core::Core;
+using engine::core::CoreConfig;
+using engine::core::PhaseId;
+using engine::core::Ticker;
+
+namespace {
+CoreConfig ManualConfig(uint32_t threads) {
+  CoreConfig config;
+  config.threads = threads;
+  config.manual_ticks = true;
+  return config;
+}
+
+class CountingTicker : public Ticker {
+ public:
+  explicit CountingTicker(PhaseId phase) : Ticker(1) { SetPhase(phase); }
+
+  void Update(const uint64_t tick) override {
+    updates_.fetch_add(1, std::memory_order_relaxed);
+    // static functions refer to the Core of the update thread
+    if (Core::global_tick() != tick) {
+      mismatches_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  [[nodiscard]] uint64_t updates() const noexcept {
+    return updates_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] uint64_t mismatches() const noexcept {
+    return mismatches_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<uint64_t> updates_ = 0;
+  std::atomic<uint64_t> mismatches_ = 0;
+};
+// Folds the updates of every object into one value, so a different order,
+// tick or time step changes it.
+struct UpdateLog {
+  uint64_t hash = 1469598103934665603ULL;
+  uint64_t updates = 0;
+
+  void Record(uint64_t id, uint64_t tick, uint64_t step_ns) {
+    for (const uint64_t value : {id, tick, step_ns}) {
+      hash = (hash ^ value) * 1099511628211ULL;
+    }
+    updates++;
+  }
+};
+
+class LoggingTicker : public Ticker {
+ public:
+  LoggingTicker(uint64_t id, uint32_t tickrate, UpdateLog& log)
+      : Ticker(tickrate), id_(id), log_(log) {}
+
+  void Update(const uint64_t tick) override {
+    // the deterministic mode updates every unbound object on one thread
+    log_.Record(id_, tick, Core::tick_delta_ns());
+  }
+
+ private:
+  const uint64_t id_;
+  UpdateLog& log_;
+};
+
+UpdateLog RunDeterministic(uint64_t ticks) {
+  UpdateLog log;
+  auto core = Core::Create(ManualConfig(4));
+  EXPECT_TRUE(core->SetDeterministic(true));
+  std::vector<std::shared_ptr<Ticker>> objects;
+  for (uint64_t id = 0; id < 64; id++) {
+    objects.push_back(
+        std::make_shared<LoggingTicker>(id, uint32_t(1 + id % 4), log));
+  }
+  core->AddTickingObjects(objects);
+  core->RunTicks(ticks);
+  return log;
+}
+}  // namespace
+
+TEST(Core, RunTicksRunsExactlyN) {
+  auto core = Core::Create(ManualConfig(2));
+  const uint64_t start = core->RunTicks(0);
+  auto ticker = std::make_shared<CountingTicker>(engine::core::phase::kUpdate);
+  core->AddTickingObject(ticker);
+  // objects are activated at the beginning of the next tick
+  EXPECT_EQ(core->RunTicks(1), start + 1);
+  const uint64_t before = ticker->updates();
+  EXPECT_EQ(core->RunTicks(100), start + 101);
+  EXPECT_EQ(ticker->updates(), before + 100);
+  // held, nothing runs in between
+  EXPECT_EQ(core->tick(), start + 101);
+  EXPECT_EQ(ticker->updates(), before + 100);
+  EXPECT_EQ(ticker->mismatches(), 0U);
+}
+
+TEST(Core, InstancesAreIndependent) {
+  auto first = Core::Create(ManualConfig(2));
+  auto second = Core::Create(ManualConfig(1));
+  auto a = std::make_shared<CountingTicker>(engine::core::phase::kUpdate);
+  auto b = std::make_shared<CountingTicker>(engine::core::phase::kUpdate);
+  first->AddTickingObject(a);
+  second->AddTickingObject(b);
+  first->RunTicks(50);
+  second->RunTicks(20);
+  first->RunTicks(50);
+  EXPECT_EQ(a->updates(), 100U);
+  EXPECT_EQ(b->updates(), 20U);
+  EXPECT_EQ(a->mismatches(), 0U);
+  EXPECT_EQ(b->mismatches(), 0U);
+}
+
+TEST(Core, StopFinishesOverlappingPhases) {
+  auto update = std::make_shared<CountingTicker>(engine::core::phase::kUpdate);
+  auto extract =
+      std::make_shared<CountingTicker>(engine::core::phase::kRenderExtract);
+  {
+    auto core = Core::Create(ManualConfig(3));
+    core->AddTickingObject(update);
+    core->AddTickingObject(extract);
+    core->RunTicks(64);
+  }
+  EXPECT_EQ(update->updates(), 64U);
+  EXPECT_EQ(extract->updates(), 64U);
+}
+
+TEST(Core, FreeRunningCoreIsDestroyedQuickly) {
+  CoreConfig config;
+  config.threads = 2;
+  auto ticker = std::make_shared<CountingTicker>(engine::core::phase::kUpdate);
+  auto core = Core::Create(config);
+  core->AddTickingObject(ticker);
+  while (ticker->updates() < 3) {
+    std::this_thread::yield();
+  }
+  const auto start = std::chrono::steady_clock::now();
+  core.reset();
+  // at most the rest of one tick, the pacing wait is skipped
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(100));
+  // the Core has released the object
+  EXPECT_EQ(ticker.use_count(), 1);
+}
+
+TEST(Core, DeterministicRunsAreIdentical) {
+  const UpdateLog first = RunDeterministic(200);
+  const UpdateLog second = RunDeterministic(200);
+  EXPECT_GT(first.updates, 0U);
+  EXPECT_EQ(first.updates, second.updates);
+  EXPECT_EQ(first.hash, second.hash);
+}
+
+TEST(Core, DeterministicIsEnabledOnlyBeforeObjects) {
+  auto core = Core::Create(ManualConfig(2));
+  auto ticker = std::make_shared<CountingTicker>(engine::core::phase::kUpdate);
+  core->AddTickingObject(ticker);
+  EXPECT_FALSE(core->SetDeterministic(true));
+  EXPECT_FALSE(core->deterministic());
+  // switching it off is always allowed
+  EXPECT_TRUE(core->SetDeterministic(false));
+}
@@ -0,0 +1,47 @@
+#include "pch.h"
+
+#include "engine/core/FixedStep.h"
+
+using engine::core::FixedStep;
+
+TEST(FixedStep, SubstepsAndCarriesRemainder) {
+  // 128 Hz on a 64 Hz tick
+  FixedStep step(128);
+  const uint64_t tick = 1000000000ULL / 64;
+  uint64_t now = 0;
+  uint32_t total = 0;
+  for (int i = 0; i < 64; i++) {
+    now += tick;
+    total += step.Advance(tick, now);
+  }
+  EXPECT_EQ(total, 128U);
+  EXPECT_EQ(step.steps(), 128U);
+
+  // 32 Hz runs every second tick
+  FixedStep slow(32);
+  EXPECT_EQ(slow.Advance(tick, tick), 0U);
+  EXPECT_NEAR(slow.alpha(tick), 0.5, 1e-6);
+  EXPECT_EQ(slow.Advance(tick, 2 * tick), 1U);
+  EXPECT_NEAR(slow.alpha(2 * tick), 0, 1e-6);
+}
+
+TEST(FixedStep, AlphaFollowsTheClock) {
+  FixedStep step(100);
+  step.Advance(25000000, 1000000000);
+  // 5ms carried over plus 2.5ms since the Advance
+  EXPECT_NEAR(step.alpha(1002500000), 0.75, 1e-6);
+  EXPECT_DOUBLE_EQ(step.alpha(2000000000), 1.0);
+  // the clock of another thread may be slightly behind
+  EXPECT_NEAR(step.alpha(999000000), 0.5, 1e-6);
+}
+
+TEST(FixedStep, DropsTimeAboveMaxSubsteps) {
+  FixedStep step(1000, 4);
+  EXPECT_EQ(step.Advance(10500000, 10500000), 4U);
+  EXPECT_EQ(step.dropped_ns(), 6000000U);
+  EXPECT_NEAR(step.alpha(10500000), 0.5, 1e-6);
+
+  step.SetRate(500);
+  EXPECT_EQ(step.step_ns(), 2000000U);
+  EXPECT_EQ(step.Advance(1500000, 12000000), 1U);
+}
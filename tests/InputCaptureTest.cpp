@@ -0,0 +1,49 @@
+#include "pch.h"
+
+#include <sstream>
+
+#include "engine/client/misc/InputCapture.h"
+
+using engine::client::InputCapture;
+
+TEST(InputCapture, SaveLoadRoundTrip) {
+  InputCapture capture;
+  capture.Add({0, 65, 38, 1, 0});
+  capture.Add({0, -1, 400, 2, 3});
+  capture.Add({700, 65, 38, 0, 0});
+  capture.SetLength(1000);
+
+  std::stringstream stream;
+  capture.Save(stream);
+  InputCapture loaded;
+  ASSERT_TRUE(loaded.Load(stream));
+
+  EXPECT_EQ(loaded.length(), 1000U);
+  ASSERT_EQ(loaded.events().size(), capture.events().size());
+  for (size_t i = 0; i < capture.events().size(); i++) {
+    auto const& expected = capture.events()[i];
+    auto const& actual = loaded.events()[i];
+    EXPECT_EQ(actual.tick, expected.tick);
+    EXPECT_EQ(actual.key, expected.key);
+    EXPECT_EQ(actual.scancode, expected.scancode);
+    EXPECT_EQ(actual.action, expected.action);
+    EXPECT_EQ(actual.mods, expected.mods);
+  }
+}
+
+TEST(InputCapture, RejectsTruncatedData) {
+  InputCapture capture;
+  capture.Add({3, 65, 38, 1, 0});
+  capture.SetLength(4);
+  std::stringstream stream;
+  capture.Save(stream);
+  std::string data = stream.str();
+
+  std::stringstream truncated(data.substr(0, data.size() - 1));
+  InputCapture loaded;
+  EXPECT_FALSE(loaded.Load(truncated));
+  EXPECT_TRUE(loaded.events().empty());
+
+  std::stringstream garbage("not a capture");
+  EXPECT_FALSE(loaded.Load(garbage));
+}
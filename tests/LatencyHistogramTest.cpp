@@ -0,0 +1,82 @@
+#include "pch.h"
+
+#include "engine/core/LatencyHistogram.h"
+
+using engine::core::LatencyHistogram;
+
+TEST(LatencyHistogram, BucketsKeepRelativeError) {
+  for (uint64_t value : {0ULL, 1ULL, 7ULL, 8ULL, 100ULL, 12345ULL,
+                         1000000ULL, 123456789ULL}) {
+    const size_t index = LatencyHistogram::BucketIndex(value);
+    ASSERT_LT(index, LatencyHistogram::kBuckets);
+    const double representative = double(LatencyHistogram::BucketValue(index));
+    EXPECT_NEAR(representative, double(value), double(value) / 16 + 1)
+        << value;
+  }
+  // buckets are ordered
+  for (uint64_t value = 1; value < 100000; value = value * 3 / 2 + 1) {
+    EXPECT_LE(LatencyHistogram::BucketIndex(value - 1),
+              LatencyHistogram::BucketIndex(value));
+  }
+}
+
+TEST(LatencyHistogram, PercentilesOfWindow) {
+  LatencyHistogram histogram;
+  const uint64_t now = LatencyHistogram::kWindowNs * 10;
+  // fits into a single window
+  for (int i = 0; i < 248; i++) {
+    histogram.Record(1000, now);
+  }
+  for (int i = 0; i < 2; i++) {
+    histogram.Record(1000000, now);
+  }
+  auto stats = histogram.stats();
+  EXPECT_EQ(stats.count, 250U);
+  EXPECT_NEAR(double(stats.p50_ns), 1000, 1000 / 16.0);
+  EXPECT_NEAR(double(stats.p99_ns), 1000, 1000 / 16.0);
+  EXPECT_NEAR(double(stats.p999_ns), 1000000, 1000000 / 16.0);
+  EXPECT_EQ(stats.max_ns, 1000000U);
+  EXPECT_NEAR(stats.mean_ns, (248 * 1000 + 2 * 1000000) / 250.0, 1);
+}
+
+TEST(LatencyHistogram, TailOfManySamples) {
+  LatencyHistogram histogram;
+  const uint64_t now = LatencyHistogram::kWindowNs * 10;
+  // 0.15% of spikes are above p999 only if the windows keep 10k samples
+  for (int i = 0; i < 10000; i++) {
+    histogram.Record(i % 1000 < 2 && i < 7500 ? 1000000 : 1000, now);
+  }
+  auto stats = histogram.stats();
+  EXPECT_EQ(stats.count, 10000U);
+  EXPECT_NEAR(double(stats.p99_ns), 1000, 1000 / 16.0);
+  EXPECT_NEAR(double(stats.p999_ns), 1000000, 1000000 / 16.0);
+}
+
+TEST(LatencyHistogram, FullWindowRotates) {
+  LatencyHistogram histogram;
+  const uint64_t now = LatencyHistogram::kWindowNs * 10;
+  for (uint32_t i = 0; i < LatencyHistogram::kMaxWindowSamples * 3; i++) {
+    histogram.Record(i < LatencyHistogram::kMaxWindowSamples ? 1000000 : 1000,
+                     now);
+  }
+  // the first window was dropped, counters didn't overflow
+  auto stats = histogram.stats();
+  EXPECT_EQ(stats.count, 2U * LatencyHistogram::kMaxWindowSamples);
+  EXPECT_NEAR(double(stats.p999_ns), 1000, 1000 / 16.0);
+  EXPECT_EQ(histogram.total_count(), 3U * LatencyHistogram::kMaxWindowSamples);
+}
+
+TEST(LatencyHistogram, OldWindowsSlideOut) {
+  LatencyHistogram histogram;
+  uint64_t now = LatencyHistogram::kWindowNs * 10;
+  histogram.Record(5000000, now);
+  now += LatencyHistogram::kWindowNs;
+  histogram.Record(100, now);
+  // the spike is still in the previous window
+  EXPECT_EQ(histogram.window_max_ns(), 5000000U);
+  now += LatencyHistogram::kWindowNs;
+  histogram.Record(100, now);
+  EXPECT_EQ(histogram.window_max_ns(), 100U);
+  EXPECT_EQ(histogram.max_ns(), 5000000U);
+  EXPECT_EQ(histogram.total_count(), 3U);
+}
@@ -0,0 +1,187 @@
+#include "pch.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "engine/Core.h"
+#include "engine/core/Clock.h"
+
+using engine::core::Clock;
+using engine::core::Core;
+using engine::core::CoreConfig;
+using engine::core::PhaseId;
+using engine::core::Ticker;
+namespace phase = engine::core::phase;
+
+namespace {
+CoreConfig ManualConfig(uint32_t threads) {
+  CoreConfig config;
+  config.threads = threads;
+  config.manual_ticks = true;
+  return config;
+}
+
+// Busy for spin_ns every update, so the thread statistics see its load.
+class SpinningTicker : public Ticker {
+ public:
+  SpinningTicker(uint64_t spin_ns, PhaseId phase)
+      : Ticker(1), spin_ns_(spin_ns) {
+    SetPhase(phase);
+  }
+  SpinningTicker(uint64_t spin_ns, PhaseId phase,
+                 std::thread::id const& thread_id)
+      : Ticker(1, thread_id), spin_ns_(spin_ns) {
+    SetPhase(phase);
+  }
+
+  void Update(const uint64_t) override {
+    // an object is updated by one thread at a time, even while it migrates
+    if (updating_.exchange(true, std::memory_order_acquire)) {
+      overlaps_.fetch_add(1, std::memory_order_relaxed);
+    }
+    const uint64_t end = Clock::now_ns() + spin_ns_;
+    while (Clock::now_ns() < end) {
+    }
+    updates_.fetch_add(1, std::memory_order_relaxed);
+    updating_.store(false, std::memory_order_release);
+  }
+  [[nodiscard]] uint64_t updates() const noexcept {
+    return updates_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] uint64_t overlaps() const noexcept {
+    return overlaps_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const uint64_t spin_ns_;
+  std::atomic<bool> updating_ = false;
+  std::atomic<uint64_t> updates_ = 0;
+  std::atomic<uint64_t> overlaps_ = 0;
+};
+
+// Runs at least one tick and up to the next rebalancing check, so the
+// following RunTicks of whole periods end on one.
+void AlignToPeriod(Core& core) {
+  const uint64_t period = core.statistics_period();
+  core.RunTicks(period - core.RunTicks(0) % period);
+}
+}  // namespace
+
+TEST(Migration, LastingImbalanceMigratesOnce) {
+  auto core = Core::Create(ManualConfig(2));
+  const uint64_t period = core->statistics_period();
+  // both start on the first thread, which has no load yet; only the light one
+  // fits into half of the gap
+  auto heavy = std::make_shared<SpinningTicker>(300000, phase::kUpdate);
+  auto light = std::make_shared<SpinningTicker>(100000, phase::kUpdate);
+  ASSERT_EQ(core->AddTickingObject(heavy), 1);
+  ASSERT_EQ(core->AddTickingObject(light), 1);
+  // a single imbalanced check is not enough
+  AlignToPeriod(*core);
+  ASSERT_EQ(heavy->owner_thread(), light->owner_thread());
+  EXPECT_EQ(core->migration_stats().migrations, 0U);
+
+  core->RunTicks(period * 6);
+  const Core::MigrationStats stats = core->migration_stats();
+  EXPECT_EQ(stats.migrations, 1U);
+  EXPECT_EQ(stats.rebalances, 1U);
+  EXPECT_GT(stats.imbalance_before, stats.imbalance_after);
+  EXPECT_NE(heavy->owner_thread(), light->owner_thread());
+
+  // the remaining imbalance can't be reduced by moving the heavy object, so
+  // nothing moves back and forth
+  core->RunTicks(period * 8);
+  EXPECT_EQ(core->migration_stats().migrations, 1U);
+  EXPECT_EQ(heavy->overlaps(), 0U);
+  EXPECT_EQ(light->overlaps(), 0U);
+}
+
+TEST(Migration, OscillatingImbalanceDoesNotMigrate) {
+  auto core = Core::Create(ManualConfig(2));
+  const uint64_t period = core->statistics_period();
+  auto heavy = std::make_shared<SpinningTicker>(300000, phase::kUpdate);
+  auto light = std::make_shared<SpinningTicker>(100000, phase::kUpdate);
+  ASSERT_EQ(core->AddTickingObject(heavy), 1);
+  ASSERT_EQ(core->AddTickingObject(light), 1);
+  AlignToPeriod(*core);
+  const uint32_t first = heavy->owner_thread();
+  const std::thread::id second = core->thread_ids()[1 - first];
+
+  // every other check the second thread is as busy as the first one; the
+  // phases don't run at the same time, so the loads don't depend on how many
+  // cores run the threads
+  for (int i = 0; i < 8; i++) {
+    auto balance =
+        std::make_shared<SpinningTicker>(400000, phase::kPreUpdate, second);
+    ASSERT_EQ(core->AddTickingObject(balance), 1);
+    core->RunTicks(period);
+    core->RemoveTickingObject(balance);
+    core->RunTicks(period);
+  }
+  EXPECT_EQ(core->migration_stats().migrations, 0U);
+  EXPECT_EQ(heavy->owner_thread(), first);
+  EXPECT_EQ(light->owner_thread(), first);
+}
+
+TEST(Migration, PendingMigrationsAreDroppedSafely) {
+  std::vector<std::shared_ptr<SpinningTicker>> kept;
+  std::vector<std::weak_ptr<SpinningTicker>> dropped;
+  uint64_t ticks = 0;
+  {
+    auto core = Core::Create(ManualConfig(2));
+    const uint64_t period = core->statistics_period();
+    const uint64_t origin = core->RunTicks(0);
+    // the render extraction may still run when the rebalancing starts, its
+    // objects are moved only after it has finished
+    std::vector<std::shared_ptr<SpinningTicker>> objects;
+    for (const PhaseId phase : {phase::kUpdate, phase::kRenderExtract}) {
+      for (int i = 0; i < 6; i++) {
+        objects.push_back(std::make_shared<SpinningTicker>(50000, phase));
+        ASSERT_EQ(core->AddTickingObject(objects.back()), 1);
+      }
+    }
+    AlignToPeriod(*core);
+    const uint32_t first = objects[0]->owner_thread();
+    core->RunTicks(period);
+
+    // the objects released now are reaped on the check which would move
+    // them, after they have been chosen as candidates
+    for (size_t i = 0; i < objects.size(); i++) {
+      if (i % 3 == 0) {
+        dropped.push_back(objects[i]);
+      } else {
+        kept.push_back(objects[i]);
+      }
+    }
+    objects.clear();
+    core->RunTicks(period * 4);
+    ASSERT_GT(core->migration_stats().migrations, 0U);
+
+    // removals of migrated objects reach their new owner
+    std::shared_ptr<SpinningTicker> removed;
+    for (auto const& object : kept) {
+      if (object->owner_thread() != first) {
+        removed = object;
+      }
+    }
+    ASSERT_NE(removed, nullptr);
+    core->RemoveTickingObject(removed);
+    core->RunTicks(2);
+    const uint64_t removed_updates = removed->updates();
+    ticks = core->RunTicks(period * 2) - origin;
+    EXPECT_EQ(removed->updates(), removed_updates);
+    EXPECT_EQ(removed.use_count(), 2);
+    std::erase(kept, removed);
+  }
+  for (auto const& object : dropped) {
+    EXPECT_TRUE(object.expired());
+  }
+  // the Core finishes the overlapping phases of the last tick
+  for (auto const& object : kept) {
+    EXPECT_EQ(object->updates(), ticks);
+    EXPECT_EQ(object->overlaps(), 0U);
+  }
+}
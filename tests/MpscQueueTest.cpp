@@ -0,0 +1,60 @@
+#include "pch.h"
+
+#include <thread>
+#include <vector>
+
+#include "engine/core/MpscQueue.h"
+
+using engine::core::MpscQueue;
+
+TEST(MpscQueue, PopsInPushOrder) {
+  MpscQueue<int, 8> queue;
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(queue.TryPush(i));
+  }
+  int value = -1;
+  for (int i = 0; i < 5; i++) {
+    ASSERT_TRUE(queue.TryPop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.TryPop(value));
+}
+
+TEST(MpscQueue, RejectsPushWhenFull) {
+  MpscQueue<int, 4> queue;
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(queue.TryPush(i));
+  }
+  EXPECT_FALSE(queue.TryPush(4));
+  int value = -1;
+  ASSERT_TRUE(queue.TryPop(value));
+  EXPECT_TRUE(queue.TryPush(4));
+}
+
+TEST(MpscQueue, DeliversEveryValueFromManyProducers) {
+  constexpr int kProducers = 4;
+  constexpr int kValuesPerProducer = 10000;
+  MpscQueue<int, 1024> queue;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; p++) {
+    producers.emplace_back([&queue]() {
+      for (int i = 1; i <= kValuesPerProducer; i++) {
+        while (!queue.TryPush(i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  int64_t sum = 0;
+  int count = 0;
+  while (count < kProducers * kValuesPerProducer) {
+    count += int(queue.Drain([&sum](int value) { sum += value; }));
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_EQ(sum, int64_t(kProducers) * kValuesPerProducer *
+                     (kValuesPerProducer + 1) / 2);
+}
@@ -0,0 +1,154 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "engine/Object.h"
+
+using engine::core::Object;
+
+namespace {
+constexpr float kEpsilon = 1e-5F;
+
+// without the default angles of the constructor
+Object MakeObject() { return Object(1, glm::vec3(0.0F), glm::vec3(0.0F)); }
+
+void ExpectNear(glm::mat4 const& actual, glm::mat4 const& expected) {
+  for (int column = 0; column < 4; column++) {
+    for (int row = 0; row < 4; row++) {
+      EXPECT_NEAR(actual[column][row], expected[column][row], kEpsilon)
+          << "[" << column << "][" << row << "]";
+    }
+  }
+}
+
+void ExpectNear(glm::vec3 const& actual, glm::vec3 const& expected) {
+  for (int i = 0; i < 3; i++) {
+    EXPECT_NEAR(actual[i], expected[i], kEpsilon) << "[" << i << "]";
+  }
+}
+
+// Angle between two orientations, q and -q are the same one.
+float AngleBetween(glm::quat const& a, glm::quat const& b) {
+  const float dot = std::min(1.0F, std::abs(glm::dot(a, b)));
+  return 2.0F * std::acos(dot);
+}
+}  // namespace
+
+TEST(Object, RotationsComposeLikeMatrices) {
+  Object object = MakeObject();
+  // the matrix post-multiplication the rotation API has replaced
+  glm::mat4 expected(1.0F);
+  auto rotate = [&expected](float angle, glm::vec3 const& axis) {
+    expected = glm::rotate(expected, angle, axis);
+  };
+  const glm::vec3 x(1.0F, 0.0F, 0.0F);
+  const glm::vec3 y(0.0F, 1.0F, 0.0F);
+  const glm::vec3 z(0.0F, 0.0F, 1.0F);
+
+  object.RotateX(0.3F);
+  rotate(0.3F, x);
+  object.RotateY(-1.1F);
+  rotate(-1.1F, y);
+  object.RotateZ(2.0F);
+  rotate(2.0F, z);
+  object.Rotate(0.7F, glm::vec3(1.0F, 2.0F, 3.0F));
+  rotate(0.7F, glm::normalize(glm::vec3(1.0F, 2.0F, 3.0F)));
+  // Euler angles are x, then y, then z
+  object.Rotate(glm::vec3(0.1F, 0.2F, 0.3F));
+  rotate(0.1F, x);
+  rotate(0.2F, y);
+  rotate(0.3F, z);
+  ExpectNear(object.rotation_matrix(), expected);
+
+  // global rotations are applied before the current one
+  object.RotateGlobal(glm::angleAxis(0.5F, y));
+  expected = glm::rotate(glm::mat4(1.0F), 0.5F, y) * expected;
+  ExpectNear(object.rotation_matrix(), expected);
+
+  object.SetRotation(glm::vec3(0.4F, -0.2F, 1.3F));
+  expected = glm::rotate(glm::rotate(glm::rotate(glm::mat4(1.0F), 0.4F, x),
+                                     -0.2F, y),
+                         1.3F, z);
+  ExpectNear(object.rotation_matrix(), expected);
+}
+
+TEST(Object, RotateTowardsInterpolates) {
+  Object object = MakeObject();
+  const glm::quat from =
+      glm::angleAxis(0.2F, glm::normalize(glm::vec3(1.0F, 1.0F, 0.0F)));
+  const glm::quat to =
+      glm::angleAxis(1.4F, glm::normalize(glm::vec3(0.0F, 1.0F, 1.0F)));
+  const float total = AngleBetween(from, to);
+
+  object.SetRotation(from);
+  object.RotateTowards(to, 0.0F);
+  EXPECT_LT(AngleBetween(object.rotation(), from), kEpsilon);
+
+  object.SetRotation(from);
+  object.RotateTowards(to, 1.0F);
+  EXPECT_LT(AngleBetween(object.rotation(), to), 1e-3F);
+
+  object.SetRotation(from);
+  object.RotateTowards(to, 0.5F);
+  EXPECT_NEAR(AngleBetween(from, object.rotation()), total / 2, 1e-3F);
+  EXPECT_NEAR(AngleBetween(object.rotation(), to), total / 2, 1e-3F);
+  const glm::quat middle = object.rotation();
+
+  // -to is the same orientation, the shorter arc gives the same midpoint
+  object.SetRotation(from);
+  object.RotateTowards(-to, 0.5F);
+  EXPECT_LT(AngleBetween(object.rotation(), middle), 1e-3F);
+}
+
+TEST(Object, LookAtHandlesUpParallelToTheDirection) {
+  Object object = MakeObject();
+  object.LookAt(glm::vec3(3.0F, 0.0F, 0.0F));
+  ExpectNear(object.forward(), glm::vec3(1.0F, 0.0F, 0.0F));
+  // the local up stays as close to the world up as possible
+  ExpectNear(object.rotation() * glm::vec3(0.0F, 1.0F, 0.0F),
+             glm::vec3(0.0F, 1.0F, 0.0F));
+
+  for (const float sign : {1.0F, -1.0F}) {
+    object.LookAt(glm::vec3(0.0F, 5.0F * sign, 0.0F));
+    const glm::quat rotation = object.rotation();
+    for (int i = 0; i < 4; i++) {
+      ASSERT_FALSE(std::isnan(rotation[i]));
+    }
+    EXPECT_NEAR(glm::length(rotation), 1.0F, kEpsilon);
+    ExpectNear(object.forward(), glm::vec3(0.0F, sign, 0.0F));
+  }
+
+  // nothing to look at
+  const glm::quat before = object.rotation();
+  object.LookAt(object.position());
+  EXPECT_EQ(object.rotation(), before);
+}
+
+TEST(Object, AxesStayOrthonormal) {
+  Object object = MakeObject();
+  for (int i = 0; i < 100000; i++) {
+    object.Rotate(0.001F * float(i % 7 + 1),
+                  glm::vec3(float(i % 3), 1.0F, float(i % 5)));
+    if (i % 3 == 0) {
+      object.RotateGlobal(glm::angleAxis(0.002F, glm::vec3(0.0F, 0.0F, 1.0F)));
+    }
+  }
+  const glm::quat rotation = object.rotation();
+  EXPECT_NEAR(glm::length(rotation), 1.0F, kEpsilon);
+  const glm::vec3 forward = object.forward();
+  const glm::vec3 right = rotation * glm::vec3(1.0F, 0.0F, 0.0F);
+  const glm::vec3 up = rotation * glm::vec3(0.0F, 1.0F, 0.0F);
+  for (glm::vec3 const& axis : {forward, right, up}) {
+    EXPECT_NEAR(glm::length(axis), 1.0F, kEpsilon);
+  }
+  EXPECT_NEAR(glm::dot(forward, right), 0.0F, kEpsilon);
+  EXPECT_NEAR(glm::dot(forward, up), 0.0F, kEpsilon);
+  EXPECT_NEAR(glm::dot(right, up), 0.0F, kEpsilon);
+  // right-handed, -Z is forward
+  ExpectNear(glm::cross(right, up), -forward);
+}
@@ -0,0 +1,250 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "engine/Core.h"
+#include "engine/core/Clock.h"
+
+using engine::core::Clock;
+using engine::core::Core;
+using engine::core::CoreConfig;
+using engine::core::Ticker;
+using engine::core::TickPriority;
+
+namespace {
+// Records the ticks on which it was updated.
+class RecordingTicker : public Ticker {
+ public:
+  explicit RecordingTicker(TickPriority priority) : Ticker(1) {
+    SetPriority(priority);
+  }
+
+  void Update(const uint64_t tick) override {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    ticks_.push_back(tick);
+  }
+  [[nodiscard]] bool updated(uint64_t tick) const {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    return std::binary_search(ticks_.begin(), ticks_.end(), tick);
+  }
+  [[nodiscard]] size_t updates() const {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    return ticks_.size();
+  }
+  [[nodiscard]] uint64_t first_tick() const {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    return ticks_.empty() ? UINT64_MAX : ticks_.front();
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  // increasing, an object is updated by one thread at a time
+  std::vector<uint64_t> ticks_;
+};
+
+// Critical object which overruns the tick budget while it's busy and records
+// the overload level of every tick.
+class LoadTicker : public Ticker {
+ public:
+  explicit LoadTicker(uint64_t spin_ns) : Ticker(1), spin_ns_(spin_ns) {
+    SetPriority(TickPriority::kCritical);
+  }
+
+  void Update(const uint64_t tick) override {
+    // changed only between ticks, so it's the level the tick runs with
+    const uint32_t level = core_->overload_stats().level;
+    {
+      std::scoped_lock<std::mutex> lock(mutex_);
+      levels_[tick] = level;
+    }
+    last_level_.store(level, std::memory_order_relaxed);
+    updates_.fetch_add(1, std::memory_order_relaxed);
+    if (busy_.load(std::memory_order_relaxed)) {
+      const uint64_t end = Clock::now_ns() + spin_ns_;
+      while (Clock::now_ns() < end) {
+      }
+    }
+  }
+  // should be called before the object is added
+  void SetCore(Core const& core) noexcept { core_ = &core; }
+  void SetBusy(bool busy) noexcept {
+    busy_.store(busy, std::memory_order_relaxed);
+  }
+  [[nodiscard]] uint32_t last_level() const noexcept {
+    return last_level_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] uint64_t updates() const noexcept {
+    return updates_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::map<uint64_t, uint32_t> levels() const {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    return levels_;
+  }
+
+ private:
+  const uint64_t spin_ns_;
+  Core const* core_ = nullptr;
+  std::atomic<bool> busy_ = false;
+  std::atomic<uint32_t> last_level_ = 0;
+  std::atomic<uint64_t> updates_ = 0;
+  mutable std::mutex mutex_;
+  std::map<uint64_t, uint32_t> levels_;
+};
+
+// Polls the condition of a free running Core, false on timeout.
+bool WaitFor(std::function<bool()> const& condition) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// The budget is 5 ms, the busy load takes twice as long.
+constexpr uint32_t kTickrate = 200;
+constexpr uint64_t kBusyNs = 10000000;
+
+struct Objects {
+  std::shared_ptr<LoadTicker> load = std::make_shared<LoadTicker>(kBusyNs);
+  std::shared_ptr<RecordingTicker> normal =
+      std::make_shared<RecordingTicker>(TickPriority::kNormal);
+  std::shared_ptr<RecordingTicker> low =
+      std::make_shared<RecordingTicker>(TickPriority::kLow);
+
+  void AddTo(Core& core) const {
+    load->SetCore(core);
+    ASSERT_EQ(core.AddTickingObject(load), 1);
+    ASSERT_EQ(core.AddTickingObject(normal), 1);
+    ASSERT_EQ(core.AddTickingObject(low), 1);
+  }
+};
+}  // namespace
+
+TEST(Overload, OffByDefaultAndInRunTicks) {
+  CoreConfig config;
+  config.threads = 2;
+  config.tickrate = kTickrate;
+  Objects objects;
+  auto core = Core::Create(config);
+  EXPECT_FALSE(core->overload_control());
+  objects.AddTo(*core);
+  objects.load->SetBusy(true);
+  ASSERT_TRUE(WaitFor([&objects]() { return objects.load->updates() >= 8; }));
+  EXPECT_EQ(core->overload_stats().level, 0U);
+  EXPECT_EQ(core->overload_stats().skipped_updates, 0U);
+
+  // RunTicks has no budget to overrun
+  core->SetOverloadControl(true);
+  const uint64_t start = core->RunTicks(0);
+  const size_t low_updates = objects.low->updates();
+  EXPECT_EQ(core->RunTicks(4), start + 4);
+  EXPECT_EQ(core->overload_stats().level, 0U);
+  EXPECT_EQ(objects.low->updates(), low_updates + 4);
+  EXPECT_EQ(core->overload_stats().skipped_updates, 0U);
+}
+
+TEST(Overload, LevelsFollowTheLoad) {
+  CoreConfig config;
+  // a migration would move the halved objects to other ticks
+  config.threads = 1;
+  config.tickrate = kTickrate;
+  Objects objects;
+  std::map<uint64_t, uint32_t> levels;
+  Core::OverloadStats stats;
+  {
+    auto core = Core::Create(config);
+    core->SetOverloadControl(true);
+    objects.AddTo(*core);
+    ASSERT_TRUE(WaitFor([&objects]() {
+      return objects.normal->updates() >= 8 && objects.low->updates() >= 8;
+    }));
+    // every tick overruns, the level goes up by one per tick
+    objects.load->SetBusy(true);
+    ASSERT_TRUE(WaitFor([&objects]() {
+      return objects.load->last_level() == Core::kMaxOverloadLevel;
+    }));
+    const uint64_t busy_updates = objects.load->updates();
+    ASSERT_TRUE(WaitFor([&objects, busy_updates]() {
+      return objects.load->updates() >= busy_updates + 8;
+    }));
+    // and down by one per kRecoveryTicks light ticks
+    objects.load->SetBusy(false);
+    ASSERT_TRUE(
+        WaitFor([&objects]() { return objects.load->last_level() == 0; }));
+    const uint64_t idle_updates = objects.load->updates();
+    ASSERT_TRUE(WaitFor([&objects, idle_updates]() {
+      return objects.load->updates() >= idle_updates + 8;
+    }));
+    stats = core->overload_stats();
+  }
+  levels = objects.load->levels();
+  EXPECT_GT(stats.overrun_ticks, 0U);
+  EXPECT_GT(stats.degraded_ticks, 2 * uint64_t(Core::kRecoveryTicks));
+  EXPECT_GT(stats.skipped_updates, 0U);
+
+  std::vector<uint32_t> transitions;
+  size_t level_one = 0;
+  size_t level_two = 0;
+  for (auto const& [tick, level] : levels) {
+    if (transitions.empty() || transitions.back() != level) {
+      transitions.push_back(level);
+    }
+    level_one += level == 1 ? 1 : 0;
+    level_two += level == 2 ? 1 : 0;
+  }
+  EXPECT_EQ(transitions, (std::vector<uint32_t>{0, 1, 2, 3, 2, 1, 0}));
+  // one tick on the way up, at least kRecoveryTicks on the way down
+  EXPECT_GT(level_one, Core::kRecoveryTicks);
+  EXPECT_GT(level_two, Core::kRecoveryTicks);
+
+  const uint64_t first = std::max(objects.normal->first_tick(),
+                                  objects.low->first_tick());
+  for (auto i = levels.lower_bound(first); i != levels.end(); i++) {
+    const auto [tick, level] = *i;
+    const auto next = std::next(i);
+    // the critical object is updated on every tick
+    if (next != levels.end()) {
+      ASSERT_EQ(next->first, tick + 1);
+    }
+    const bool same_next = next != levels.end() && next->second == level;
+    switch (level) {
+      case 0:
+        EXPECT_TRUE(objects.normal->updated(tick)) << tick;
+        EXPECT_TRUE(objects.low->updated(tick)) << tick;
+        break;
+      case 1:
+        EXPECT_TRUE(objects.normal->updated(tick)) << tick;
+        // halved objects are updated on every other tick
+        if (same_next) {
+          EXPECT_NE(objects.low->updated(tick), objects.low->updated(tick + 1))
+              << tick;
+        }
+        break;
+      case 2:
+        EXPECT_TRUE(objects.normal->updated(tick)) << tick;
+        EXPECT_FALSE(objects.low->updated(tick)) << tick;
+        break;
+      default:
+        if (same_next) {
+          EXPECT_NE(objects.normal->updated(tick),
+                    objects.normal->updated(tick + 1))
+              << tick;
+        }
+        EXPECT_FALSE(objects.low->updated(tick)) << tick;
+        break;
+    }
+  }
+}
@@ -0,0 +1,145 @@
+#include "pch.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "engine/Core.h"
+#include "engine/HierarchyTicker.h"
+#include "engine/SnapshotTicker.h"
+#include "engine/core/RenderSnapshots.h"
+#include "engine/core/TripleBuffer.h"
+
+using engine::core::Core;
+using engine::core::CoreConfig;
+using engine::core::HierarchyTicker;
+using engine::core::PhaseId;
+using engine::core::RenderSnapshot;
+using engine::core::RenderSnapshots;
+using engine::core::SnapshotTicker;
+using engine::core::TransformHandle;
+using engine::core::TransformHierarchy;
+using engine::core::TransformStore;
+using engine::core::TripleBuffer;
+namespace phase = engine::core::phase;
+
+namespace {
+glm::mat4 Translation(glm::vec3 const& position) {
+  return glm::translate(glm::mat4(1.0F), position);
+}
+
+struct Scene {
+  TransformStore store;
+  TransformHierarchy hierarchy{store};
+  RenderSnapshots snapshots{store, hierarchy};
+
+  TransformHandle Add(glm::vec3 const& position) {
+    return store.Add(position, glm::quat(1.0F, 0.0F, 0.0F, 0.0F),
+                     glm::vec3(1.0F));
+  }
+};
+}  // namespace
+
+TEST(TripleBuffer, ReaderSeesWholePublishedValues) {
+  TripleBuffer<std::array<uint64_t, 64>> buffer;
+  EXPECT_FALSE(buffer.Acquire());
+  constexpr uint64_t kValues = 100000;
+  std::atomic<bool> done = false;
+  std::thread writer([&buffer, &done]() {
+    for (uint64_t value = 1; value <= kValues; value++) {
+      buffer.back().fill(value);
+      buffer.Publish();
+    }
+    done = true;
+  });
+  uint64_t last = 0;
+  while (!done) {
+    buffer.Acquire();
+    const auto& front = buffer.front();
+    for (const uint64_t value : front) {
+      ASSERT_EQ(value, front[0]);
+    }
+    ASSERT_GE(front[0], last);
+    last = front[0];
+  }
+  writer.join();
+  buffer.Acquire();
+  EXPECT_EQ(buffer.front()[0], kValues);
+  EXPECT_FALSE(buffer.Acquire());
+}
+
+TEST(RenderSnapshots, FrontKeepsTheCapturedTick) {
+  Scene scene;
+  const TransformHandle a = scene.Add(glm::vec3(1.0F, 0.0F, 0.0F));
+  const TransformHandle b = scene.Add(glm::vec3(0.0F, 2.0F, 0.0F));
+  const uint32_t id_a = scene.snapshots.Add(a);
+  const uint32_t id_b = scene.snapshots.Add(b);
+  // b follows a
+  const auto node_a = scene.hierarchy.Add(a);
+  const auto node_b = scene.hierarchy.Add(b, node_a);
+  scene.snapshots.SetNode(id_b, node_b);
+  scene.hierarchy.Propagate();
+
+  scene.snapshots.Capture(1, 0);
+  RenderSnapshot const& first = scene.snapshots.Acquire();
+  EXPECT_EQ(first.tick, 1U);
+  EXPECT_EQ(first.world_matrix(id_a), Translation(glm::vec3(1, 0, 0)));
+  EXPECT_EQ(first.world_matrix(id_b), Translation(glm::vec3(1, 2, 0)));
+
+  // the simulation moves on, the acquired snapshot doesn't change
+  scene.store.SetPosition(a, glm::vec3(5.0F, 0.0F, 0.0F));
+  scene.hierarchy.MarkDirty(node_a);
+  scene.hierarchy.Propagate();
+  EXPECT_EQ(scene.snapshots.front().world_matrix(id_b),
+            Translation(glm::vec3(1, 2, 0)));
+  scene.snapshots.Capture(2, 0);
+  EXPECT_EQ(scene.snapshots.front().tick, 1U);
+
+  // removed ids are captured as the identity
+  scene.snapshots.Remove(id_a);
+  scene.snapshots.Capture(3, 0);
+  RenderSnapshot const& last = scene.snapshots.Acquire();
+  EXPECT_EQ(last.tick, 3U);
+  EXPECT_EQ(last.world_matrix(id_a), glm::mat4(1.0F));
+  EXPECT_EQ(last.world_matrix(id_b), Translation(glm::vec3(5, 2, 0)));
+  EXPECT_EQ(scene.snapshots.Add(a), id_a);
+}
+
+TEST(RenderSnapshots, TickerPublishesEveryTick) {
+  // outlives the Core which updates it
+  auto scene = std::make_shared<Scene>();
+  CoreConfig config;
+  config.threads = 4;
+  config.manual_ticks = true;
+  auto core = Core::Create(config);
+  constexpr size_t kRenderables = SnapshotTicker::kGrain * 4 + 3;
+  for (size_t i = 0; i < kRenderables; i++) {
+    scene->snapshots.Add(scene->Add(glm::vec3(float(i), 0.0F, 0.0F)));
+  }
+  const PhaseId snapshot_phase =
+      core->DeclarePhase("Snapshot", {phase::kPostUpdate});
+  ASSERT_NE(snapshot_phase, phase::kMaxPhases);
+  // the Core releases objects nobody else holds
+  auto hierarchy_ticker = std::make_shared<HierarchyTicker>(scene->hierarchy);
+  auto snapshot_ticker =
+      std::make_shared<SnapshotTicker>(snapshot_phase, scene->snapshots);
+  ASSERT_EQ(core->AddTickingObject(hierarchy_ticker), 1);
+  ASSERT_EQ(core->AddTickingObject(snapshot_ticker), 1);
+  core->RunTicks(3);
+
+  RenderSnapshot const& snapshot = scene->snapshots.Acquire();
+  EXPECT_GT(snapshot.tick, 0U);
+  ASSERT_EQ(snapshot.world_matrices.size(), kRenderables);
+  for (uint32_t i = 0; i < kRenderables; i++) {
+    ASSERT_EQ(snapshot.world_matrix(i),
+              Translation(glm::vec3(float(i), 0.0F, 0.0F)))
+        << "renderable " << i;
+  }
+  const uint64_t tick = snapshot.tick;
+  core->RunTicks(1);
+  EXPECT_EQ(scene->snapshots.Acquire().tick, tick + 1);
+}
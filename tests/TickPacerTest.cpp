@@ -0,0 +1,31 @@
+#include "pch.h"
+
+#include <chrono>
+
+#include "engine/core/TickPacer.h"
+
+using engine::core::TickPacer;
+using namespace std::chrono_literals;
+
+TEST(TickPacer, SpinWindowIsCalibratedByTheFirstHybridWait) {
+  TickPacer pacer(0ns);
+  EXPECT_EQ(pacer.spin_window(), 0ns);
+  // neither of them needs the window
+  pacer.SetMode(TickPacer::Mode::kSleep);
+  pacer.WaitUntil(TickPacer::Clock::now() + 1ms);
+  pacer.SetMode(TickPacer::Mode::kBusySpin);
+  pacer.WaitUntil(TickPacer::Clock::now() + 1ms);
+  EXPECT_EQ(pacer.spin_window(), 0ns);
+
+  pacer.SetMode(TickPacer::Mode::kHybrid);
+  pacer.WaitUntil(TickPacer::Clock::now() + 5ms);
+  EXPECT_GE(pacer.spin_window(), 50us);
+  EXPECT_LE(pacer.spin_window(), 2ms);
+  EXPECT_EQ(pacer.lateness().count(), 3U);
+
+  // a window set before the first wait is kept
+  TickPacer configured(0ns);
+  configured.SetSpinWindow(300us);
+  configured.WaitUntil(TickPacer::Clock::now() + 5ms);
+  EXPECT_EQ(configured.spin_window(), 300us);
+}
@@ -0,0 +1,137 @@
+#include "pch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "engine/Core.h"
+
+using engine::core::Background;
+using engine::core::Core;
+using engine::core::CoreConfig;
+using engine::core::NextTick;
+using engine::core::Ticks;
+using engine::core::TickTask;
+
+namespace {
+CoreConfig ManualConfig(uint32_t threads) {
+  CoreConfig config;
+  config.threads = threads;
+  config.manual_ticks = true;
+  return config;
+}
+
+TickTask RecordTicks(std::shared_ptr<std::vector<uint64_t>> ticks) {
+  ticks->push_back(Core::global_tick());
+  co_await NextTick();
+  ticks->push_back(Core::global_tick());
+  co_await Ticks(0);
+  co_await Ticks(5);
+  ticks->push_back(Core::global_tick());
+}
+
+TickTask Sleep(std::shared_ptr<std::atomic<uint64_t>> resumes) {
+  resumes->fetch_add(1);
+  co_await Ticks(1000000);
+  resumes->fetch_add(1);
+}
+
+TickTask Child(std::shared_ptr<std::vector<uint64_t>> ticks) {
+  co_await Ticks(3);
+  ticks->push_back(Core::global_tick());
+}
+
+TickTask Parent(std::shared_ptr<std::vector<uint64_t>> ticks) {
+  ticks->push_back(Core::global_tick());
+  co_await Child(ticks);
+  ticks->push_back(Core::global_tick());
+  co_await NextTick();
+  ticks->push_back(Core::global_tick());
+}
+
+struct BackgroundResult {
+  std::thread::id job_thread;
+  std::thread::id resumed_thread;
+  int value = 0;
+  std::atomic<bool> done = false;
+};
+
+TickTask Load(std::shared_ptr<BackgroundResult> result) {
+  // a named job, GCC 12 destroys lambda temporaries with captures in the
+  // co_await operand twice
+  auto job = [result]() {
+    result->job_thread = std::this_thread::get_id();
+    return 42;
+  };
+  result->value = co_await Background(std::move(job));
+  result->resumed_thread = std::this_thread::get_id();
+  result->done = true;
+}
+}  // namespace
+
+TEST(TickTask, ResumesOnTheAwaitedTick) {
+  auto core = Core::Create(ManualConfig(2));
+  const uint64_t start = core->RunTicks(0);
+  auto ticks = std::make_shared<std::vector<uint64_t>>();
+  EXPECT_TRUE(core->Spawn(RecordTicks(ticks)));
+  EXPECT_EQ(core->task_count(), 1U);
+  core->RunTicks(10);
+  // the Core holds after the start tick, the task starts in the next one
+  EXPECT_EQ(*ticks,
+            (std::vector<uint64_t>{start + 1, start + 2, start + 7}));
+  EXPECT_EQ(core->task_count(), 0U);
+}
+
+TEST(TickTask, NestedTaskResumesCaller) {
+  auto core = Core::Create(ManualConfig(2));
+  const uint64_t start = core->RunTicks(0);
+  auto ticks = std::make_shared<std::vector<uint64_t>>();
+  core->Spawn(Parent(ticks));
+  core->RunTicks(10);
+  EXPECT_EQ(*ticks, (std::vector<uint64_t>{start + 1, start + 4, start + 4,
+                                           start + 5}));
+  EXPECT_EQ(core->task_count(), 0U);
+}
+
+TEST(TickTask, SuspendedTasksAreNotPolled) {
+  auto resumes = std::make_shared<std::atomic<uint64_t>>(0);
+  {
+    auto core = Core::Create(ManualConfig(2));
+    for (int i = 0; i < 1000; i++) {
+      core->Spawn(Sleep(resumes));
+    }
+    core->RunTicks(50);
+    // only the first resume, the tasks sleep for the rest of the run
+    EXPECT_EQ(resumes->load(), 1000U);
+    EXPECT_EQ(core->task_count(), 1000U);
+  }
+  // the frames are destroyed with the Core and release what they hold
+  EXPECT_EQ(resumes.use_count(), 1);
+}
+
+TEST(TickTask, BackgroundJobResumesOnUpdateThread) {
+  auto core = Core::Create(ManualConfig(2));
+  auto result = std::make_shared<BackgroundResult>();
+  core->Spawn(Load(result));
+  for (int i = 0; i < 10000 && !result->done; i++) {
+    core->RunTicks(1);
+  }
+  ASSERT_TRUE(result->done);
+  EXPECT_EQ(result->value, 42);
+  const auto ids = core->thread_ids();
+  EXPECT_EQ(std::count(ids.begin(), ids.end(), result->job_thread), 0);
+  EXPECT_EQ(std::count(ids.begin(), ids.end(), result->resumed_thread), 1);
+  EXPECT_EQ(core->task_count(), 0U);
+}
+
+TEST(TickTask, SpawnRejectsUndeclaredPhase) {
+  auto core = Core::Create(ManualConfig(1));
+  auto ticks = std::make_shared<std::vector<uint64_t>>();
+  EXPECT_FALSE(core->Spawn(RecordTicks(ticks), 30));
+  EXPECT_FALSE(core->Spawn(TickTask()));
+  EXPECT_EQ(core->task_count(), 0U);
+  // the rejected task is destroyed without running
+  EXPECT_EQ(ticks.use_count(), 1);
+}
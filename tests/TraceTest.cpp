@@ -0,0 +1,60 @@
+#include "pch.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "engine/core/Trace.h"
+
+using engine::core::Trace;
+
+namespace {
+size_t CountOf(std::string const& text, std::string const& pattern) {
+  size_t count = 0;
+  for (size_t i = text.find(pattern); i != std::string::npos;
+       i = text.find(pattern, i + 1)) {
+    count++;
+  }
+  return count;
+}
+}  // namespace
+
+TEST(Trace, WritesEventsOfEveryThread) {
+  Trace::Clear();
+  std::thread worker([] {
+    Trace::SetThreadName("worker \"1\"");
+    Trace::Record("work", 1000, 3500);
+  });
+  worker.join();
+  Trace::Record("main", 2000000, 2000001);
+
+  std::stringstream stream;
+  Trace::WriteJson(stream);
+  const std::string json = stream.str();
+  EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0U);
+  EXPECT_NE(json.find("\"args\":{\"name\":\"worker \\\"1\\\"\"}"),
+            std::string::npos);
+  EXPECT_NE(json.find("{\"name\":\"work\",\"cat\":\"engine\",\"ph\":\"X\""),
+            std::string::npos);
+  EXPECT_NE(json.find("\"ts\":1.000,\"dur\":2.500"), std::string::npos);
+  EXPECT_NE(json.find("\"ts\":2000.000,\"dur\":0.001"), std::string::npos);
+}
+
+TEST(Trace, KeepsTheLastEvents) {
+  Trace::Clear();
+  for (uint64_t i = 0; i < Trace::kBufferSize + 100; i++) {
+    Trace::Record(i < 100 ? "old" : "new", i, i + 1);
+  }
+  std::stringstream stream;
+  Trace::WriteJson(stream);
+  const std::string json = stream.str();
+  EXPECT_EQ(CountOf(json, "\"name\":\"old\""), 0U);
+  // the oldest slot is the one the owner would overwrite next, so it is
+  // skipped
+  EXPECT_EQ(CountOf(json, "\"name\":\"new\""), Trace::kBufferSize - 1);
+
+  Trace::Clear();
+  std::stringstream cleared;
+  Trace::WriteJson(cleared);
+  EXPECT_EQ(CountOf(cleared.str(), "\"ph\":\"X\""), 0U);
+}
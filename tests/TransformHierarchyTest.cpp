@@ -0,0 +1,230 @@
+#include "pch.h"
+
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "engine/Core.h"
+#include "engine/HierarchyTicker.h"
+#include "engine/core/TransformHierarchy.h"
+
+using engine::core::Core;
+using engine::core::CoreConfig;
+using engine::core::HierarchyTicker;
+using engine::core::NodeHandle;
+using engine::core::TransformHandle;
+using engine::core::TransformHierarchy;
+using engine::core::TransformStore;
+
+namespace {
+float MaxDifference(glm::mat4 const& a, glm::mat4 const& b) {
+  float difference = 0;
+  for (int column = 0; column < 4; column++) {
+    for (int row = 0; row < 4; row++) {
+      difference =
+          std::max(difference, std::abs(a[column][row] - b[column][row]));
+    }
+  }
+  return difference;
+}
+
+glm::mat4 Local(TransformStore const& store, TransformHandle transform) {
+  return glm::translate(glm::mat4(1.0F), store.position(transform)) *
+         glm::mat4_cast(store.rotation(transform)) *
+         glm::scale(glm::mat4(1.0F), store.scale(transform));
+}
+
+// Transforms and nodes of a test hierarchy, with the world matrices
+// computed by walking up the parents.
+struct Scene {
+  TransformStore store;
+  TransformHierarchy hierarchy{store};
+  std::vector<TransformHandle> transforms;
+  std::vector<NodeHandle> nodes;
+  std::vector<size_t> parents;
+
+  static constexpr size_t kRoot = SIZE_MAX;
+
+  size_t Add(size_t parent) {
+    const float i = float(nodes.size());
+    transforms.push_back(store.Add(
+        glm::vec3(i * 0.01F, 1.0F, -0.5F),
+        glm::angleAxis(0.001F * i, glm::normalize(glm::vec3(1, 2, 3))),
+        glm::vec3(1.0F + 0.0001F * i)));
+    nodes.push_back(hierarchy.Add(
+        transforms.back(), parent == kRoot ? NodeHandle{} : nodes[parent]));
+    parents.push_back(parent);
+    return nodes.size() - 1;
+  }
+
+  void Move(size_t i, glm::vec3 const& offset) {
+    store.SetPosition(transforms[i], store.position(transforms[i]) + offset);
+    hierarchy.MarkDirty(nodes[i]);
+  }
+
+  [[nodiscard]] glm::mat4 Expected(size_t i) const {
+    glm::mat4 world = Local(store, transforms[i]);
+    for (size_t parent = parents[i]; parent != kRoot;
+         parent = parents[parent]) {
+      world = Local(store, transforms[parent]) * world;
+    }
+    return world;
+  }
+
+  void ExpectWorldMatrices() const {
+    for (size_t i = 0; i < nodes.size(); i++) {
+      const glm::mat4 expected = Expected(i);
+      ASSERT_LT(MaxDifference(hierarchy.world_matrix(nodes[i]), expected),
+                1e-3F * (1.0F + std::abs(expected[3][0])))
+          << "node " << i;
+    }
+  }
+};
+}  // namespace
+
+TEST(TransformHierarchy, ChildFollowsParent) {
+  Scene scene;
+  const size_t parent = scene.Add(Scene::kRoot);
+  const size_t child = scene.Add(parent);
+  EXPECT_EQ(scene.hierarchy.parent(scene.nodes[child]), scene.nodes[parent]);
+  EXPECT_EQ(scene.hierarchy.Propagate(), 2U);
+  scene.ExpectWorldMatrices();
+
+  scene.Move(parent, glm::vec3(5.0F, 0.0F, 0.0F));
+  EXPECT_EQ(scene.hierarchy.Propagate(), 2U);
+  scene.ExpectWorldMatrices();
+  // nothing has changed
+  EXPECT_EQ(scene.hierarchy.Propagate(), 0U);
+}
+
+TEST(TransformHierarchy, RebuildsOnlyDirtySubtrees) {
+  Scene scene;
+  // 8 roots with 8 children with 8 children
+  for (size_t root = 0; root < 8; root++) {
+    const size_t r = scene.Add(Scene::kRoot);
+    for (size_t child = 0; child < 8; child++) {
+      const size_t c = scene.Add(r);
+      for (size_t leaf = 0; leaf < 8; leaf++) {
+        scene.Add(c);
+      }
+    }
+  }
+  EXPECT_EQ(scene.hierarchy.Propagate(), scene.nodes.size());
+
+  // a child with 8 leaves, a leaf of it and a leaf elsewhere
+  scene.Move(1, glm::vec3(1.0F));
+  scene.Move(2, glm::vec3(1.0F));
+  scene.Move(scene.nodes.size() - 1, glm::vec3(1.0F));
+  EXPECT_EQ(scene.hierarchy.Propagate(), 9U + 1U);
+  scene.ExpectWorldMatrices();
+  // the leaf covered by its parent is marked dirty again
+  scene.Move(2, glm::vec3(1.0F));
+  EXPECT_EQ(scene.hierarchy.Propagate(), 1U);
+  scene.ExpectWorldMatrices();
+
+  // the child covered by its root, then the child and a leaf of it alone
+  scene.Move(0, glm::vec3(0.5F));
+  scene.Move(1, glm::vec3(0.5F));
+  EXPECT_EQ(scene.hierarchy.Propagate(), 1U + 8U + 64U);
+  scene.Move(1, glm::vec3(0.5F));
+  EXPECT_EQ(scene.hierarchy.Propagate(), 9U);
+  scene.Move(2, glm::vec3(0.5F));
+  EXPECT_EQ(scene.hierarchy.Propagate(), 1U);
+  scene.ExpectWorldMatrices();
+
+  // moving a root costs its subtree
+  scene.Move(0, glm::vec3(-1.0F));
+  EXPECT_EQ(scene.hierarchy.Propagate(), 1U + 8U + 64U);
+  scene.ExpectWorldMatrices();
+}
+
+TEST(TransformHierarchy, SetParentAndRemove) {
+  Scene scene;
+  const size_t a = scene.Add(Scene::kRoot);
+  const size_t b = scene.Add(a);
+  const size_t c = scene.Add(b);
+  scene.hierarchy.Propagate();
+
+  // c is a descendant of a
+  EXPECT_FALSE(scene.hierarchy.SetParent(scene.nodes[a], scene.nodes[c]));
+  EXPECT_FALSE(scene.hierarchy.SetParent(scene.nodes[a], scene.nodes[a]));
+
+  EXPECT_TRUE(scene.hierarchy.SetParent(scene.nodes[c], {}));
+  scene.parents[c] = Scene::kRoot;
+  EXPECT_TRUE(scene.hierarchy.SetParent(scene.nodes[a], scene.nodes[c]));
+  scene.parents[a] = c;
+  scene.hierarchy.Propagate();
+  scene.ExpectWorldMatrices();
+
+  // b becomes a child of c
+  scene.hierarchy.Remove(scene.nodes[a]);
+  EXPECT_FALSE(scene.hierarchy.valid(scene.nodes[a]));
+  EXPECT_EQ(scene.hierarchy.parent(scene.nodes[a]), NodeHandle{});
+  EXPECT_EQ(scene.hierarchy.world_matrix(scene.nodes[a]), glm::mat4(1.0F));
+  EXPECT_EQ(scene.hierarchy.world_matrix({}), glm::mat4(1.0F));
+  EXPECT_EQ(scene.hierarchy.parent(scene.nodes[b]), scene.nodes[c]);
+  EXPECT_EQ(scene.hierarchy.size(), 2U);
+  scene.parents[b] = c;
+  scene.hierarchy.Propagate();
+  EXPECT_LT(MaxDifference(scene.hierarchy.world_matrix(scene.nodes[b]),
+                          scene.Expected(b)),
+            1e-4F);
+}
+
+TEST(TransformHierarchy, WideSubtreesAreSplitBetweenThreads) {
+  Scene scene;
+  const size_t root = scene.Add(Scene::kRoot);
+  constexpr size_t kChildren = TransformHierarchy::kParallelWidth * 3;
+  for (size_t i = 0; i < kChildren; i++) {
+    const size_t child = scene.Add(root);
+    scene.Add(child);
+  }
+  scene.Add(Scene::kRoot);
+  scene.hierarchy.Propagate();
+
+  scene.Move(root, glm::vec3(0.0F, 2.0F, 0.0F));
+  scene.Move(scene.nodes.size() - 1, glm::vec3(1.0F));
+  // the root and the other small subtree are propagated right away
+  const size_t split = scene.hierarchy.PrepareParallel();
+  ASSERT_EQ(split, kChildren);
+  std::vector<std::thread> threads;
+  std::atomic<size_t> rebuilt = 0;
+  constexpr size_t kThreads = 4;
+  for (size_t t = 0; t < kThreads; t++) {
+    threads.emplace_back([&scene, &rebuilt, split, t]() {
+      rebuilt += scene.hierarchy.PropagateRange(split * t / kThreads,
+                                                split * (t + 1) / kThreads);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(rebuilt.load(), kChildren * 2);
+  scene.ExpectWorldMatrices();
+}
+
+TEST(TransformHierarchy, TickerPropagatesInPostUpdate) {
+  // outlives the Core which updates it
+  auto scene = std::make_shared<Scene>();
+  CoreConfig config;
+  config.threads = 4;
+  config.manual_ticks = true;
+  auto core = Core::Create(config);
+  const size_t root = scene->Add(Scene::kRoot);
+  for (size_t i = 0; i < TransformHierarchy::kParallelWidth * 2; i++) {
+    scene->Add(scene->Add(root));
+  }
+  // the Core releases objects nobody else holds
+  auto ticker = std::make_shared<HierarchyTicker>(scene->hierarchy);
+  ASSERT_EQ(core->AddTickingObject(ticker), 1);
+  core->RunTicks(2);
+  scene->ExpectWorldMatrices();
+
+  scene->Move(root, glm::vec3(3.0F, 0.0F, 0.0F));
+  core->RunTicks(1);
+  scene->ExpectWorldMatrices();
+}
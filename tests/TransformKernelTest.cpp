@@ -0,0 +1,94 @@
+#include "pch.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "engine/core/TransformKernel.h"
+
+using engine::core::SimdLevel;
+using engine::core::TransformKernel;
+
+namespace {
+struct RandomTransforms {
+  std::vector<float> components[10];
+
+  explicit RandomTransforms(size_t count) {
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> position(-50.0F, 50.0F);
+    std::uniform_real_distribution<float> unit(-1.0F, 1.0F);
+    std::uniform_real_distribution<float> scale(0.1F, 3.0F);
+    for (size_t i = 0; i < count; i++) {
+      const glm::quat rotation = glm::normalize(
+          glm::quat(unit(random), unit(random), unit(random), unit(random)));
+      const float values[10] = {position(random), position(random),
+                                position(random), rotation.x,
+                                rotation.y,       rotation.z,
+                                rotation.w,       scale(random),
+                                scale(random),    scale(random)};
+      for (size_t c = 0; c < 10; c++) {
+        components[c].push_back(values[c]);
+      }
+    }
+  }
+
+  [[nodiscard]] engine::core::TransformArrays arrays() const {
+    return {components[0].data(), components[1].data(), components[2].data(),
+            components[3].data(), components[4].data(), components[5].data(),
+            components[6].data(), components[7].data(), components[8].data(),
+            components[9].data()};
+  }
+  [[nodiscard]] glm::mat4 expected(size_t i) const {
+    const glm::vec3 position(components[0][i], components[1][i],
+                             components[2][i]);
+    const glm::quat rotation(components[6][i], components[3][i],
+                             components[4][i], components[5][i]);
+    const glm::vec3 scale(components[7][i], components[8][i],
+                          components[9][i]);
+    return glm::translate(glm::mat4(1.0F), position) *
+           glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0F), scale);
+  }
+};
+}  // namespace
+
+TEST(TransformKernel, EverySupportedLevelMatchesGlm) {
+  // not a multiple of any width, so every path has a tail
+  constexpr size_t kCount = 16 * 5 + 8 + 4 + 3;
+  const RandomTransforms transforms(kCount);
+  for (auto level : {SimdLevel::kScalar, SimdLevel::kSse, SimdLevel::kAvx2,
+                     SimdLevel::kAvx512}) {
+    const TransformKernel::Function function = TransformKernel::function(level);
+    if (function == nullptr) {
+      EXPECT_GT(level, TransformKernel::supported_level());
+      continue;
+    }
+    // one matrix past the end shows writes out of bounds
+    std::vector<glm::mat4> out(kCount + 1, glm::mat4(7.0F));
+    function(transforms.arrays(), kCount, out.data());
+    for (size_t i = 0; i < kCount; i++) {
+      const glm::mat4 expected = transforms.expected(i);
+      for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+          ASSERT_NEAR(out[i][column][row], expected[column][row], 1e-4F)
+              << TransformKernel::name(level) << " matrix " << i;
+        }
+      }
+    }
+    EXPECT_EQ(out[kCount], glm::mat4(7.0F)) << TransformKernel::name(level);
+  }
+}
+
+TEST(TransformKernel, SetLevelRejectsUnsupportedLevels) {
+  const SimdLevel initial = TransformKernel::level();
+  EXPECT_LE(initial, TransformKernel::supported_level());
+  EXPECT_TRUE(TransformKernel::SetLevel(SimdLevel::kScalar));
+  EXPECT_EQ(TransformKernel::level(), SimdLevel::kScalar);
+  if (TransformKernel::supported_level() != SimdLevel::kAvx512) {
+    EXPECT_FALSE(TransformKernel::SetLevel(SimdLevel::kAvx512));
+    EXPECT_EQ(TransformKernel::level(), SimdLevel::kScalar);
+  }
+  EXPECT_TRUE(TransformKernel::SetLevel(initial));
+}
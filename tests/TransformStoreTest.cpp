@@ -0,0 +1,113 @@
+#include "pch.h"
+
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "engine/core/TransformStore.h"
+
+using engine::core::TransformHandle;
+using engine::core::TransformStore;
+
+namespace {
+float MaxDifference(glm::mat4 const& a, glm::mat4 const& b) {
+  float difference = 0;
+  for (int column = 0; column < 4; column++) {
+    for (int row = 0; row < 4; row++) {
+      difference =
+          std::max(difference, std::abs(a[column][row] - b[column][row]));
+    }
+  }
+  return difference;
+}
+}  // namespace
+
+TEST(TransformStore, ModelMatrixMatchesGlm) {
+  TransformStore store;
+  const glm::vec3 position(1.0F, -2.0F, 3.5F);
+  const glm::quat rotation = glm::normalize(
+      glm::angleAxis(0.7F, glm::normalize(glm::vec3(1.0F, 2.0F, -0.5F))));
+  const glm::vec3 scale(2.0F, 0.5F, 3.0F);
+  const TransformHandle handle = store.Add(position, rotation, scale);
+  ASSERT_TRUE(store.valid(handle));
+  EXPECT_TRUE(store.dirty(handle));
+  store.UpdateModelMatrix(handle);
+  EXPECT_FALSE(store.dirty(handle));
+
+  const glm::mat4 expected = glm::translate(glm::mat4(1.0F), position) *
+                             glm::mat4_cast(rotation) *
+                             glm::scale(glm::mat4(1.0F), scale);
+  EXPECT_LT(MaxDifference(store.model_matrix(handle), expected), 1e-5F);
+}
+
+TEST(TransformStore, RebuildsOnlyDirtyTransforms) {
+  TransformStore store;
+  std::vector<TransformHandle> handles;
+  // spans several pages
+  for (uint32_t i = 0; i < TransformStore::kPageSize * 3 + 5; i++) {
+    handles.push_back(store.Add(glm::vec3(float(i)), glm::quat(1, 0, 0, 0),
+                                glm::vec3(1.0F)));
+  }
+  EXPECT_EQ(store.page_count(), 4U);
+  EXPECT_EQ(store.UpdateModelMatrices(), handles.size());
+  EXPECT_EQ(store.UpdateModelMatrices(), 0U);
+
+  store.SetPosition(handles[7], glm::vec3(-1.0F));
+  store.SetScale(handles[7], glm::vec3(2.0F));
+  store.SetPosition(handles[TransformStore::kPageSize * 3], glm::vec3(5.0F));
+  EXPECT_EQ(store.UpdateModelMatrices(), 2U);
+  EXPECT_EQ(store.model_matrix(handles[7])[3], glm::vec4(-1, -1, -1, 1));
+  EXPECT_EQ(store.model_matrix(handles[7])[0][0], 2.0F);
+}
+
+TEST(TransformStore, RemovedSlotsAreReusedWithNewGeneration) {
+  TransformStore store;
+  const TransformHandle first =
+      store.Add(glm::vec3(1.0F), glm::quat(1, 0, 0, 0), glm::vec3(1.0F));
+  store.Remove(first);
+  EXPECT_FALSE(store.valid(first));
+  EXPECT_EQ(store.size(), 0U);
+  // removed transforms aren't rebuilt
+  EXPECT_EQ(store.UpdateModelMatrices(), 0U);
+
+  const TransformHandle second =
+      store.Add(glm::vec3(2.0F), glm::quat(1, 0, 0, 0), glm::vec3(1.0F));
+  EXPECT_EQ(second.index, first.index);
+  EXPECT_NE(second.generation, first.generation);
+  EXPECT_TRUE(store.valid(second));
+  // a stale handle doesn't remove the new transform
+  store.Remove(first);
+  EXPECT_TRUE(store.valid(second));
+  EXPECT_EQ(store.position(second), glm::vec3(2.0F));
+}
+
+TEST(TransformStore, ConcurrentAddAndWrite) {
+  TransformStore store;
+  constexpr uint32_t kThreads = 4;
+  constexpr uint32_t kPerThread = 3000;
+  std::vector<std::vector<TransformHandle>> handles(kThreads);
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < kThreads; t++) {
+    threads.emplace_back([&store, &handles, t]() {
+      for (uint32_t i = 0; i < kPerThread; i++) {
+        const TransformHandle handle = store.Add(
+            glm::vec3(float(t)), glm::quat(1, 0, 0, 0), glm::vec3(1.0F));
+        store.SetPosition(handle, glm::vec3(float(t), float(i), 0.0F));
+        handles[t].push_back(handle);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(store.size(), kThreads * kPerThread);
+  EXPECT_EQ(store.UpdateModelMatrices(), kThreads * kPerThread);
+  for (uint32_t t = 0; t < kThreads; t++) {
+    for (uint32_t i = 0; i < kPerThread; i++) {
+      ASSERT_EQ(store.model_matrix(handles[t][i])[3],
+                glm::vec4(float(t), float(i), 0.0F, 1.0F));
+    }
+  }
+}